@@ -137,6 +137,7 @@ These python modules are linked with the core library.
         feature/feature-line-distance
 
         traces/reader
+        traces/recorder
 
         tools/time-stamp
         tools/timer
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2020,
+ * CNRS/AIST
+ *
+ */
+
+#ifndef __SOT_BINARY_TRACE_HH__
+#define __SOT_BINARY_TRACE_HH__
+
+/* --------------------------------------------------------------------- */
+/* --- INCLUDE --------------------------------------------------------- */
+/* --------------------------------------------------------------------- */
+
+#include <sot/core/api.hh>
+
+#include <cstddef>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace dynamicgraph {
+namespace sot {
+
+/** \brief Header of a binary trace, written by Recorder and read by
+  sotReader.
+
+  A binary trace is made of:
+  - a header: the magic string "SOTTRACE", the byte order mark 0x01020304,
+    the version of the format, the number of signals and the size of the
+    block of names, then the number of rows and columns of each signal, all
+    as uint32_t, then the block of names: the names of the signals, each
+    terminated by a null character, padded with zeros to a multiple of 8
+    bytes,
+  - the records, one per time step: the time followed by the values of the
+    signals, matrices in row major order, all as doubles.
+
+  Integers and doubles use the byte order of the machine. The size of the
+  header is a multiple of 8 bytes so that the records of a file mapped in
+  memory are aligned.
+*/
+struct SOT_CORE_EXPORT BinaryTraceHeader {
+  struct Entry {
+    std::string name;
+    uint32_t rows, cols;
+  };
+  std::vector<Entry> entries;
+
+  /// Number of doubles of a record.
+  std::size_t recordSize(void) const;
+
+  void write(std::ostream &os) const;
+  /// Whether data starts with the magic string of a binary trace.
+  static bool isBinaryTrace(const char *data, const std::size_t size);
+  /// \return the size of the header.
+  /// \throw ExceptionTraces if data does not start with a valid header.
+  std::size_t read(const char *data, const std::size_t size);
+};
+
+} /* namespace sot */
+} /* namespace dynamicgraph */
+
+#endif /* #ifndef __SOT_BINARY_TRACE_HH__ */
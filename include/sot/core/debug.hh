@@ -10,7 +10,10 @@
 #ifndef SOT_CORE_DEBUG_HH
 #define SOT_CORE_DEBUG_HH
 #include "sot/core/api.hh"
+#include <algorithm>
+#include <atomic>
 #include <cstdarg>
+#include <cstddef>
 #include <cstdio>
 #include <fstream>
 #include <sstream>
@@ -23,17 +26,96 @@
 #define VP_TEMPLATE_DEBUG_MODE 0
 #endif //! VP_TEMPLATE_DEBUG_MODE
 
+/* --- MODULES -------------------------------------------------------------- */
+/* The module of a file, SOLVER, FEATURE, TASK, FILTER or TOOLS, is given by
+ * SOT_DEBUG_MODULE, which CMake sets from the directory of the file. The
+ * messages of a module are compiled up to level VP_DEBUG_MODE_<MODULE>, which
+ * is VP_DEBUG_MODE by default. */
+
+#ifndef SOT_DEBUG_MODULE
+#define SOT_DEBUG_MODULE TOOLS
+#endif //! SOT_DEBUG_MODULE
+
+#ifndef VP_DEBUG_MODE_SOLVER
+#define VP_DEBUG_MODE_SOLVER VP_DEBUG_MODE
+#endif //! VP_DEBUG_MODE_SOLVER
+#ifndef VP_DEBUG_MODE_FEATURE
+#define VP_DEBUG_MODE_FEATURE VP_DEBUG_MODE
+#endif //! VP_DEBUG_MODE_FEATURE
+#ifndef VP_DEBUG_MODE_TASK
+#define VP_DEBUG_MODE_TASK VP_DEBUG_MODE
+#endif //! VP_DEBUG_MODE_TASK
+#ifndef VP_DEBUG_MODE_FILTER
+#define VP_DEBUG_MODE_FILTER VP_DEBUG_MODE
+#endif //! VP_DEBUG_MODE_FILTER
+#ifndef VP_DEBUG_MODE_TOOLS
+#define VP_DEBUG_MODE_TOOLS VP_DEBUG_MODE
+#endif //! VP_DEBUG_MODE_TOOLS
+
+#define sotDEBUG_CAT(a, b) a##b
+#define sotDEBUG_EXPAND_CAT(a, b) sotDEBUG_CAT(a, b)
+/// Level up to which the messages of the module of the file are compiled.
+#define sotDEBUG_COMPILED_LEVEL                                                \
+  sotDEBUG_EXPAND_CAT(VP_DEBUG_MODE_, SOT_DEBUG_MODULE)
+/// Module of the file, as a DebugModule.
+#define sotDEBUG_MODULE                                                        \
+  dynamicgraph::sot::sotDEBUG_EXPAND_CAT(DEBUG_, SOT_DEBUG_MODULE)
+
 #define SOT_COMMON_TRACES                                                      \
   do {                                                                         \
     va_list arg;                                                               \
     va_start(arg, format);                                                     \
     vsnprintf(charbuffer, SIZE, format, arg);                                  \
     va_end(arg);                                                               \
-    outputbuffer << tmpbuffer.str() << charbuffer << std::endl;                \
+    DebugRecord(*this).stream() << tmpbuffer.str() << charbuffer << std::endl; \
   } while (0)
 
 namespace dynamicgraph {
 namespace sot {
+class DebugTrace;
+struct DebugRing;
+
+/// Subsystems with their own debug levels.
+enum DebugModule {
+  DEBUG_SOLVER,
+  DEBUG_FEATURE,
+  DEBUG_TASK,
+  DEBUG_FILTER,
+  DEBUG_TOOLS,
+  DEBUG_MODULE_COUNT
+};
+
+/** One message of sotDEBUG or sotERROR, written in the stream returned by
+  stream() until the record is destroyed, at the end of the statement.
+
+  When the real-time backend is started (DebugTrace::startRealTime), the
+  message is written in a preallocated record of a ring of the calling
+  thread, with the location and the time, without lock, allocation nor
+  system call. Otherwise, it is written directly in the output of the flow,
+  holding the lock of the debug file.
+  */
+class SOT_CORE_EXPORT DebugRecord {
+public:
+  /// \param file, function, line: location written before the message, if
+  /// file is not NULL.
+  DebugRecord(DebugTrace &flow, const char *file = NULL,
+              const char *function = NULL, const int line = 0,
+              const bool error = false);
+  ~DebugRecord(void);
+
+  std::ostream &stream(void) { return *stream_; }
+
+private:
+  DebugRecord(const DebugRecord &);
+  DebugRecord &operator=(const DebugRecord &);
+
+  std::ostream *stream_;
+  /// Ring of the record, NULL if it is not written in a ring.
+  DebugRing *ring_;
+  /// Whether the record holds the lock of the debug file.
+  bool locked_;
+};
+
 class SOT_CORE_EXPORT DebugTrace {
 public:
   static const int SIZE = 512;
@@ -59,7 +141,7 @@ public:
 
   inline void trace(const int level = -1) {
     if (level <= traceLevel)
-      outputbuffer << tmpbuffer.str();
+      DebugRecord(*this).stream() << tmpbuffer.str();
     tmpbuffer.str("");
   }
 
@@ -84,6 +166,34 @@ public:
   static const char *DEBUG_FILENAME_DEFAULT;
   static void openFile(const char *filename = DEBUG_FILENAME_DEFAULT);
   static void closeFile(const char *filename = DEBUG_FILENAME_DEFAULT);
+
+  /// \name Real-time backend
+  /// Each thread writes its messages in a ring of capacity records of
+  /// SIZE characters, allocated at its first message or by registerThread,
+  /// and a thread writes the records to the debug file. A message is
+  /// dropped when the ring is full, and the number of dropped messages is
+  /// written in the file.
+  /// @{
+  static void startRealTime(const std::size_t capacity = 256);
+  /// Write the records of the rings and stop the thread which writes them.
+  static void stopRealTime(void);
+  static bool isRealTime(void);
+  /// Allocate the ring of the calling thread, to be called before its
+  /// real-time loop.
+  static void registerThread(void);
+  /// @}
+
+  /// \name Levels
+  /// The compiled messages of a module are written up to the level of the
+  /// module set at runtime, all of them by default, while the debug file is
+  /// open. Level -1 disables the errors too.
+  /// @{
+  static void setLevel(const DebugModule module, const int level);
+  static int getLevel(const DebugModule module);
+  /// Level up to which the messages of each module are written, -1 when the
+  /// file is closed.
+  static std::atomic<int> writtenLevels[DEBUG_MODULE_COUNT];
+  /// @}
 };
 
 SOT_CORE_EXPORT extern DebugTrace sotDEBUGFLOW;
@@ -91,6 +201,26 @@ SOT_CORE_EXPORT extern DebugTrace sotERRORFLOW;
 } // namespace sot
 } // namespace dynamicgraph
 
+/// Whether a message of level of the module of the file is written. The
+/// comparison with the compiled level is resolved at compile time, and the
+/// one with the runtime level is a single branch.
+#define sotDEBUG_WRITTEN(level, compiledLevel)                                 \
+  ((level) <= (compiledLevel) &&                                               \
+   (level) <= dynamicgraph::sot::DebugTrace::writtenLevels[sotDEBUG_MODULE]    \
+                  .load(std::memory_order_relaxed))
+
+/// Level up to which the messages of the module of the file are written.
+#define sotDEBUG_LEVEL(compiledLevel)                                          \
+  std::min<int>(compiledLevel,                                                 \
+                dynamicgraph::sot::DebugTrace::writtenLevels[sotDEBUG_MODULE]  \
+                    .load(std::memory_order_relaxed))
+
+/// Record of a message of flow, with the location of the calling line.
+#define sotRECORD(flow, error)                                                 \
+  dynamicgraph::sot::DebugRecord(flow, __FILE__, __FUNCTION__, __LINE__,       \
+                                 error)                                        \
+      .stream()
+
 #ifdef VP_DEBUG
 #define sotPREDEBUG                                                            \
   __FILE__ << ": " << __FUNCTION__ << "(#" << __LINE__ << ") :"
@@ -99,66 +229,57 @@ SOT_CORE_EXPORT extern DebugTrace sotERRORFLOW;
   "\t!! " << __FILE__ << ": " << __FUNCTION__ << "(#" << __LINE__ << ") :"
 
 #define sotDEBUG(level)                                                        \
-  if ((level > VP_DEBUG_MODE) ||                                               \
-      (!dynamicgraph::sot::sotDEBUGFLOW.outputbuffer.good()))                  \
+  if (!sotDEBUG_WRITTEN(level, sotDEBUG_COMPILED_LEVEL))                       \
     ;                                                                          \
   else                                                                         \
-    dynamicgraph::sot::sotDEBUGFLOW.outputbuffer << sotPREDEBUG
+    sotRECORD(dynamicgraph::sot::sotDEBUGFLOW, false)
 
 #define sotDEBUGMUTE(level)                                                    \
-  if ((level > VP_DEBUG_MODE) ||                                               \
-      (!dynamicgraph::sot::sotDEBUGFLOW.outputbuffer.good()))                  \
+  if (!sotDEBUG_WRITTEN(level, sotDEBUG_COMPILED_LEVEL))                       \
     ;                                                                          \
   else                                                                         \
-    dynamicgraph::sot::sotDEBUGFLOW.outputbuffer
+    dynamicgraph::sot::DebugRecord(dynamicgraph::sot::sotDEBUGFLOW).stream()
 
 #define sotERROR                                                               \
-  if (!dynamicgraph::sot::sotDEBUGFLOW.outputbuffer.good())                    \
+  if (!sotDEBUG_WRITTEN(0, 0))                                                 \
     ;                                                                          \
   else                                                                         \
-    dynamicgraph::sot::sotERRORFLOW.outputbuffer << sotPREERROR
+    sotRECORD(dynamicgraph::sot::sotERRORFLOW, true)
 
 #define sotDEBUGF                                                              \
-  if (!dynamicgraph::sot::sotDEBUGFLOW.outputbuffer.good())                    \
+  if (!sotDEBUG_WRITTEN(0, 0))                                                 \
     ;                                                                          \
   else                                                                         \
     dynamicgraph::sot::sotDEBUGFLOW                                            \
         .pre(dynamicgraph::sot::sotDEBUGFLOW.tmpbuffer << sotPREDEBUG,         \
-             VP_DEBUG_MODE)                                                    \
+             sotDEBUG_LEVEL(sotDEBUG_COMPILED_LEVEL))                          \
         .trace
 
 #define sotERRORF                                                              \
-  if (!dynamicgraph::sot::sotDEBUGFLOW.outputbuffer.good())                    \
+  if (!sotDEBUG_WRITTEN(0, 0))                                                 \
     ;                                                                          \
   else                                                                         \
     sot::sotERRORFLOW.pre(sot::sotERRORFLOW.tmpbuffer << sotPREERROR).trace
 
 // TEMPLATE
 #define sotTDEBUG(level)                                                       \
-  if ((level > VP_TEMPLATE_DEBUG_MODE) ||                                      \
-      (!dynamicgraph::sot::sotDEBUGFLOW.outputbuffer.good()))                  \
+  if (!sotDEBUG_WRITTEN(level, VP_TEMPLATE_DEBUG_MODE))                        \
     ;                                                                          \
   else                                                                         \
-    dynamicgraph::sot::sotDEBUGFLOW.outputbuffer << sotPREDEBUG
+    sotRECORD(dynamicgraph::sot::sotDEBUGFLOW, false)
 
 #define sotTDEBUGF                                                             \
-  if (!dynamicgraph::sot::sotDEBUGFLOW.outputbuffer.good())                    \
+  if (!sotDEBUG_WRITTEN(0, 0))                                                 \
     ;                                                                          \
   else                                                                         \
     dynamicgraph::sot::sotDEBUGFLOW                                            \
         .pre(dynamicgraph::sot::sotDEBUGFLOW.tmpbuffer << sotPREDEBUG,         \
-             VP_TEMPLATE_DEBUG_MODE)                                           \
+             sotDEBUG_LEVEL(VP_TEMPLATE_DEBUG_MODE))                           \
         .trace
 
-namespace dynamicgraph {
-namespace sot {
-inline bool sotDEBUG_ENABLE(const int &level) { return level <= VP_DEBUG_MODE; }
-
-inline bool sotTDEBUG_ENABLE(const int &level) {
-  return level <= VP_TEMPLATE_DEBUG_MODE;
-}
-} // namespace sot
-} // namespace dynamicgraph
+/// Whether the messages of level are compiled.
+#define sotDEBUG_ENABLE(level) ((level) <= sotDEBUG_COMPILED_LEVEL)
+#define sotTDEBUG_ENABLE(level) ((level) <= VP_TEMPLATE_DEBUG_MODE)
 
 /* -------------------------------------------------------------------------- */
 #else // VP_DEBUG
@@ -174,7 +295,11 @@ inline bool sotTDEBUG_ENABLE(const int &level) {
     ;                                                                          \
   else                                                                         \
     ::dynamicgraph::sot::__null_stream()
-#define sotERROR sotERRORFLOW.outputbuffer << sotPREERROR
+#define sotERROR                                                               \
+  if (!sotDEBUG_WRITTEN(0, 0))                                                 \
+    ;                                                                          \
+  else                                                                         \
+    sotRECORD(dynamicgraph::sot::sotERRORFLOW, true)
 
 namespace dynamicgraph {
 namespace sot {
@@ -35,7 +35,8 @@ public:
     ,
     CORBA,
     KALMAN_SIZE,
-    PARAMETER_SERVER
+    PARAMETER_SERVER,
+    KALMAN_NOT_INVERTIBLE
   };
 
   static const std::string EXCEPTION_NAME;
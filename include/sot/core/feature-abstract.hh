@@ -120,6 +120,17 @@ public:
   inline unsigned int getDimension(void) const {
     return dimensionSOUT.accessCopy();
   }
+
+  /*! \brief Version of the topology of the feature.
+    \par time: The time at which the feature should be considered.
+    \return A counter which is incremented each time the dimension of the
+    feature changes, so that the users of the feature only need to
+    recompute their memory layout when it changes.
+  */
+  inline unsigned int getTopologyVersion(int time) {
+    dimensionSOUT(time);
+    return topologyVersion;
+  }
   /*! @} */
 
   /*! \name Methods to control internal computation.
@@ -222,6 +233,18 @@ public:
   void setReferenceByName(const std::string &name);
   std::string getReferenceByName(void) const;
   /*! @} */
+
+protected:
+  /*! \brief Notify a change of the topology of the feature which is not
+    driven by its signals, for instance a command changing its dimension. */
+  void topologyChanged(void);
+
+private:
+  /// Callback of dimensionSOUT, which keeps topologyVersion up to date.
+  unsigned int &computeDimension(unsigned int &res, int time);
+
+  unsigned int topologyVersion;
+  unsigned int lastDimension;
 };
 
 template <class FeatureSpecialized> class FeatureReferenceHelper {
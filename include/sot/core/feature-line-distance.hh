@@ -83,6 +83,67 @@ public:
                                                int time);
 
   virtual void display(std::ostream &os) const;
+
+  /// Error between the line (p0, u0) and the reference line (p1, u1),
+  /// \f$ e = (p_1 - p_0).n / |n|^2 \f$ with \f$ n = u_0 \times u_1 \f$.
+  /// If not NULL, dp0 and du0 are set to the gradients of e wrt p0 and u0.
+  static double computeDistance(const Eigen::Vector3d &p0,
+                                const Eigen::Vector3d &u0,
+                                const Eigen::Vector3d &p1,
+                                const Eigen::Vector3d &u1,
+                                Eigen::Vector3d *dp0 = NULL,
+                                Eigen::Vector3d *du0 = NULL);
+};
+
+/*!
+  \class FeatureLineDistances
+  \brief Stacked version of FeatureLineDistance.
+
+  The N lines go through the origin of the same body, with directions given
+  in the body frame by the stacked vector signal (size 3N). Each of them is
+  compared to a reference line, the stacked positionRef signal (size 6N).
+  The selection flags select the lines.
+*/
+class SOTFEATURELINEDISTANCE_EXPORT FeatureLineDistances
+    : public FeatureAbstract {
+
+public:
+  static const std::string CLASS_NAME;
+  virtual const std::string &getClassName(void) const { return CLASS_NAME; }
+
+  /* --- SIGNALS ------------------------------------------------------------ */
+public:
+  dynamicgraph::SignalPtr<MatrixHomogeneous, int> positionSIN;
+  dynamicgraph::SignalPtr<dynamicgraph::Matrix, int> articularJacobianSIN;
+  dynamicgraph::SignalPtr<dynamicgraph::Vector, int> positionRefSIN;
+  dynamicgraph::SignalPtr<dynamicgraph::Vector, int> vectorSIN;
+  /// Stacked coordinates (point, direction) of the lines.
+  dynamicgraph::SignalTimeDependent<dynamicgraph::Vector, int> lineSOUT;
+
+  using FeatureAbstract::errorSOUT;
+  using FeatureAbstract::jacobianSOUT;
+  using FeatureAbstract::selectionSIN;
+
+  DECLARE_NO_REFERENCE;
+
+public:
+  FeatureLineDistances(const std::string &name);
+  virtual ~FeatureLineDistances(void) {}
+
+  virtual unsigned int &getDimension(unsigned int &dim, int time);
+
+  virtual dynamicgraph::Vector &computeError(dynamicgraph::Vector &res,
+                                             int time);
+  virtual dynamicgraph::Matrix &computeJacobian(dynamicgraph::Matrix &res,
+                                                int time);
+  dynamicgraph::Vector &computeLineCoordinates(dynamicgraph::Vector &cood,
+                                               int time);
+
+  virtual void display(std::ostream &os) const;
+
+protected:
+  /// Selected rows of the differential of the error wrt the body velocity.
+  Eigen::Matrix<double, Eigen::Dynamic, 6> diffh;
 };
 
 } /* namespace sot */
@@ -28,6 +28,20 @@ namespace sot {
 /// Enum used to specify what difference operation is used in FeaturePose.
 enum Representation_t { SE3Representation, R3xSO3Representation };
 
+/// Quantities of a FeaturePose which are shared by the computation of the
+/// error, of its time derivative and of the Jacobian.
+struct FeaturePoseState {
+  typedef Eigen::Matrix<double, 6, 6, Eigen::RowMajor> Jacobian_t;
+
+  /// \f$ {}^{fa}M_{fb} \ominus {}^{fa}M^*_{fb} \f$
+  Vector6d error;
+  /// Derivative of \c error wrt \f$ {}^{fa}M_{fb} \f$.
+  Jacobian_t dError_dfaMfb;
+  /// Derivative of \c error wrt \f$ {}^{fa}M^*_{fb} \f$. It is only
+  /// computed when the desired velocity is plugged.
+  Jacobian_t dError_dfaMfbDes;
+};
+
 /*!
   \brief Feature that controls the relative (or absolute) pose between
   two frames A (or world) and B.
@@ -104,6 +118,10 @@ public:
   SignalTimeDependent<Vector7, int> q_faMfbDes;
   /*! @} */
 
+  /// Difference between the current and the desired pose and its
+  /// derivatives, computed once per time step.
+  SignalTimeDependent<FeaturePoseState, int> kinematicStateSINTERN;
+
   using FeatureAbstract::errorSOUT;
   using FeatureAbstract::jacobianSOUT;
   using FeatureAbstract::selectionSIN;
@@ -148,8 +166,7 @@ private:
   MatrixHomogeneous &computefaMfb(MatrixHomogeneous &res, int time);
   Vector7 &computeQfaMfb(Vector7 &res, int time);
   Vector7 &computeQfaMfbDes(Vector7 &res, int time);
-
-  /// \todo Intermediate variables for internal computations
+  FeaturePoseState &computeKinematicState(FeaturePoseState &res, int time);
 };
 
 template <typename T>
@@ -169,6 +186,10 @@ typedef FeaturePose<R3xSO3Representation> FeaturePose_t;
 typedef FeaturePose<SE3Representation> FeaturePoseSE3_t;
 
 } /* namespace sot */
+
+template <>
+struct signal_io<sot::FeaturePoseState>
+    : signal_io_unimplemented<sot::FeaturePoseState> {};
 } /* namespace dynamicgraph */
 
 #endif // #ifndef __SOT_FEATURE_POSE_HH__
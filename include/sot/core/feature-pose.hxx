@@ -72,23 +72,28 @@ FeaturePose<representation>::FeaturePose(const std::string &pointName)
       q_faMfbDes(boost::bind(&FeaturePose<representation>::computeQfaMfbDes,
                              this, _1, _2),
                  faMfbDes,
-                 CLASS_NAME + "(" + name + ")::output(vector7)::q_faMfbDes") {
+                 CLASS_NAME + "(" + name + ")::output(vector7)::q_faMfbDes"),
+      kinematicStateSINTERN(
+          boost::bind(&FeaturePose<representation>::computeKinematicState,
+                      this, _1, _2),
+          q_faMfb << q_faMfbDes,
+          CLASS_NAME + "(" + name + ")::intern(state)::kinematicState") {
   oMja.setConstant(Id);
   jaMfa.setConstant(Id);
   jbMfb.setConstant(Id);
   faMfbDes.setConstant(Id);
   faNufafbDes.setConstant(Vector::Zero(6));
 
-  jacobianSOUT.addDependencies(q_faMfbDes << q_faMfb << jaJja << jbJjb);
+  jacobianSOUT.addDependencies(kinematicStateSINTERN << jaJja << jbJjb);
 
-  errorSOUT.addDependencies(q_faMfbDes << q_faMfb);
+  errorSOUT.addDependency(kinematicStateSINTERN);
 
   signalRegistration(oMja << jaMfa << oMjb << jbMfb << jaJja << jbJjb);
   signalRegistration(faMfb << errordotSOUT << faMfbDes << faNufafbDes);
 
   errordotSOUT.setFunction(
       boost::bind(&FeaturePose<representation>::computeErrorDot, this, _1, _2));
-  errordotSOUT.addDependencies(q_faMfbDes << q_faMfb << faNufafbDes);
+  errordotSOUT.addDependencies(kinematicStateSINTERN << faNufafbDes);
 
   // Commands
   //
@@ -128,10 +133,7 @@ unsigned int &FeaturePose<representation>::getDimension(unsigned int &dim,
 
   const Flags &fl = selectionSIN.access(time);
 
-  dim = 0;
-  for (int i = 0; i < 6; ++i)
-    if (fl(i))
-      dim++;
+  dim = static_cast<unsigned int>(fl.count(6));
 
   sotDEBUG(25) << "# Out }" << std::endl;
   return dim;
@@ -154,8 +156,7 @@ Matrix &FeaturePose<representation>::computeJacobian(Matrix &J, int time) {
 
   check(*this);
 
-  q_faMfb.recompute(time);
-  q_faMfbDes.recompute(time);
+  const FeaturePoseState &state = kinematicStateSINTERN(time);
 
   const unsigned int &dim = dimensionSOUT(time);
   const Flags &fl = selectionSIN(time);
@@ -164,44 +165,42 @@ Matrix &FeaturePose<representation>::computeJacobian(Matrix &J, int time) {
 
   const MatrixHomogeneous &_jbMfb =
       (jbMfb.isPlugged() ? jbMfb.accessCopy() : Id);
+  const MatrixHomogeneous &_faMfb = faMfb(time);
 
   const Matrix::Index cJ = _jbJjb.cols();
   J.resize(dim, cJ);
 
   MatrixTwist X;
-  Eigen::Matrix<double, 6, 6, Eigen::RowMajor> Jminus;
 
-  buildFrom(_jbMfb.inverse(Eigen::Affine), X);
-  MatrixRotation faRfb = jaMfa.access(time).rotation().transpose() *
-                         oMja.access(time).rotation().transpose() *
-                         oMjb.access(time).rotation() * _jbMfb.rotation();
+  buildFrom(_jbMfb.inverse(Eigen::Isometry), X);
+  const MatrixRotation faRfb = _faMfb.rotation();
   if (boost::is_same<LieGroup_t, R3xSO3_t>::value)
     X.topRows<3>().applyOnTheLeft(faRfb);
-  LieGroup_t().template dDifference<pinocchio::ARG1>(
-      q_faMfbDes.accessCopy(), q_faMfb.accessCopy(), Jminus);
+
+  // Gather the selected rows of Jminus once, so that only the rows of
+  // Jminus * X which are actually used are computed.
+  typedef Eigen::Matrix<double, Eigen::Dynamic, 6, Eigen::RowMajor, 6, 6>
+      SelectedRows_t;
+  SelectedRows_t JminusSel, JminusSelX(dim, 6);
+  fl.gatherRows(state.dError_dfaMfb, JminusSel);
 
   // Contribution of b:
   // J = Jminus * X * jbJjb;
-  unsigned int rJ = 0;
-  for (unsigned int r = 0; r < 6; ++r)
-    if (fl((int)r))
-      J.row(rJ++) = (Jminus * X).row(r) * _jbJjb;
+  JminusSelX.noalias() = JminusSel * X;
+  J.noalias() = JminusSelX * _jbJjb;
 
   if (jaJja.isPlugged()) {
     const Matrix &_jaJja = jaJja(time);
     const MatrixHomogeneous &_jaMfa =
-                                (jaMfa.isPlugged() ? jaMfa.accessCopy() : Id),
-                            _faMfb = faMfb.accessCopy();
+        (jaMfa.isPlugged() ? jaMfa.accessCopy() : Id);
 
-    buildFrom((_jaMfa * _faMfb).inverse(Eigen::Affine), X);
+    buildFrom((_jaMfa * _faMfb).inverse(Eigen::Isometry), X);
     if (boost::is_same<LieGroup_t, R3xSO3_t>::value)
       X.topRows<3>().applyOnTheLeft(faRfb);
 
     // J -= (Jminus * X) * jaJja(time);
-    rJ = 0;
-    for (unsigned int r = 0; r < 6; ++r)
-      if (fl((int)r))
-        J.row(rJ++).noalias() -= (Jminus * X).row(r) * _jaJja;
+    JminusSelX.noalias() = JminusSel * X;
+    J.noalias() -= JminusSelX * _jaJja;
   }
 
   return J;
@@ -212,7 +211,7 @@ MatrixHomogeneous &
 FeaturePose<representation>::computefaMfb(MatrixHomogeneous &res, int time) {
   check(*this);
 
-  res = (oMja(time) * jaMfa(time)).inverse(Eigen::Affine) * oMjb(time) *
+  res = (oMja(time) * jaMfa(time)).inverse(Eigen::Isometry) * oMjb(time) *
         jbMfb(time);
   return res;
 }
@@ -234,20 +233,29 @@ Vector7 &FeaturePose<representation>::computeQfaMfbDes(Vector7 &res, int time) {
 }
 
 template <Representation_t representation>
-Vector &FeaturePose<representation>::computeError(Vector &error, int time) {
+FeaturePoseState &
+FeaturePose<representation>::computeKinematicState(FeaturePoseState &res,
+                                                   int time) {
   typedef typename internal::LG_t<representation>::type LieGroup_t;
   check(*this);
 
-  const Flags &fl = selectionSIN(time);
+  const Vector7 &q = q_faMfb(time);
+  const Vector7 &qDes = q_faMfbDes(time);
+  LieGroup_t lg;
+
+  lg.difference(qDes, q, res.error);
+  lg.template dDifference<pinocchio::ARG1>(qDes, q, res.dError_dfaMfb);
+  if (faNufafbDes.isPlugged())
+    lg.template dDifference<pinocchio::ARG0>(qDes, q, res.dError_dfaMfbDes);
+  return res;
+}
 
-  Eigen::Matrix<double, 6, 1> v;
-  LieGroup_t().difference(q_faMfbDes(time), q_faMfb(time), v);
+template <Representation_t representation>
+Vector &FeaturePose<representation>::computeError(Vector &error, int time) {
+  check(*this);
 
-  error.resize(dimensionSOUT(time));
-  unsigned int cursor = 0;
-  for (unsigned int i = 0; i < 6; ++i)
-    if (fl((int)i))
-      error(cursor++) = v(i);
+  const Flags &fl = selectionSIN(time);
+  fl.gatherRows(kinematicStateSINTERN(time).error, error);
 
   return error;
 }
@@ -261,7 +269,7 @@ Vector6d convertVelocity<SE3_t>(const MatrixHomogeneous &M,
                                 const Vector &faNufafbDes) {
   (void)M;
   MatrixTwist X;
-  buildFrom(Mdes.inverse(Eigen::Affine), X);
+  buildFrom(Mdes.inverse(Eigen::Isometry), X);
   return X * faNufafbDes;
 }
 template <>
@@ -288,22 +296,13 @@ Vector &FeaturePose<representation>::computeErrorDot(Vector &errordot,
     return errordot;
   }
 
-  q_faMfb.recompute(time);
-  q_faMfbDes.recompute(time);
-  faNufafbDes.recompute(time);
-
+  const FeaturePoseState &state = kinematicStateSINTERN(time);
   const MatrixHomogeneous &_faMfbDes = faMfbDes(time);
 
-  Eigen::Matrix<double, 6, 6, Eigen::RowMajor> Jminus;
-
-  LieGroup_t().template dDifference<pinocchio::ARG0>(
-      q_faMfbDes.accessCopy(), q_faMfb.accessCopy(), Jminus);
   Vector6d nu = convertVelocity<LieGroup_t>(faMfb(time), _faMfbDes,
-                                            faNufafbDes.accessCopy());
-  unsigned int cursor = 0;
-  for (unsigned int i = 0; i < 6; ++i)
-    if (fl((int)i))
-      errordot(cursor++) = Jminus.row(i) * nu;
+                                            faNufafbDes(time));
+  const Vector6d errordotFull = state.dError_dfaMfbDes * nu;
+  fl.gatherRows(errordotFull, errordot);
 
   return errordot;
 }
@@ -321,7 +320,7 @@ void FeaturePose<representation>::servoCurrentPosition(const int &time) {
                           _oMjb = oMjb.access(time),
                           _jbMfb =
                               (jbMfb.isPlugged() ? jbMfb.access(time) : Id);
-  faMfbDes = (_oMja * _jaMfa).inverse(Eigen::Affine) * _oMjb * _jbMfb;
+  faMfbDes = (_oMja * _jaMfa).inverse(Eigen::Isometry) * _oMjb * _jbMfb;
 }
 
 static const char *featureNames[] = {"X ", "Y ", "Z ", "RX", "RY", "RZ"};
@@ -77,6 +77,7 @@ protected:
 private:
   std::vector<bool> activeDofs_;
   std::size_t nbActiveDofs_;
+  std::vector<Eigen::Index> activeDofIndices_;
 }; // class FeaturePosture
 } // namespace sot
 } // namespace dynamicgraph
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2020,
+ * CNRS/AIST
+ *
+ */
+
+#ifndef __SOT_FEATURE_VISUALPOINTS_HH__
+#define __SOT_FEATURE_VISUALPOINTS_HH__
+
+/* --------------------------------------------------------------------- */
+/* --- INCLUDE --------------------------------------------------------- */
+/* --------------------------------------------------------------------- */
+
+/* SOT */
+#include <sot/core/exception-task.hh>
+#include <sot/core/feature-abstract.hh>
+
+/* --------------------------------------------------------------------- */
+/* --- API ------------------------------------------------------------- */
+/* --------------------------------------------------------------------- */
+
+#if defined(WIN32)
+#if defined(feature_visual_points_EXPORTS)
+#define SOTFEATUREVISUALPOINTS_EXPORT __declspec(dllexport)
+#else
+#define SOTFEATUREVISUALPOINTS_EXPORT __declspec(dllimport)
+#endif
+#else
+#define SOTFEATUREVISUALPOINTS_EXPORT
+#endif
+
+/* --------------------------------------------------------------------- */
+/* --- CLASS ----------------------------------------------------------- */
+/* --------------------------------------------------------------------- */
+
+namespace dynamicgraph {
+namespace sot {
+
+/*!
+  \class FeatureVisualPoints
+  \brief Class that defines a set of 2D visual points as a single feature.
+
+  This is the stacked version of FeatureVisualPoint: the input signal xy
+  is \f$ (x_0, y_0, x_1, y_1, ...) \f$ and Z gives the depth of each point.
+  The interaction matrix of all the points is computed in one pass over
+  contiguous copies of the coordinates, its interleaved x and y rows being
+  written with a stride of 2. The
+  selection flags apply to the rows of the stacked error, so that
+  Flags("0011") selects the second point only.
+*/
+class SOTFEATUREVISUALPOINTS_EXPORT FeatureVisualPoints
+    : public FeatureAbstract,
+      public FeatureReferenceHelper<FeatureVisualPoints> {
+
+public:
+  static const std::string CLASS_NAME;
+  virtual const std::string &getClassName(void) const { return CLASS_NAME; }
+
+protected:
+  /// Interaction matrix of all the points, and its selected rows.
+  dynamicgraph::Matrix L, Lselected;
+  /// Coordinates and inverse depth of the points, kept between the
+  /// evaluations to avoid allocations.
+  Eigen::ArrayXd xCoordinates, yCoordinates, inverseDepth;
+
+  /* --- SIGNALS ------------------------------------------------------------ */
+public:
+  /// Stacked coordinates of the points.
+  dynamicgraph::SignalPtr<dynamicgraph::Vector, int> xySIN;
+  /// Depth of each point (required to compute the interaction matrix).
+  dynamicgraph::SignalPtr<dynamicgraph::Vector, int> ZSIN;
+  dynamicgraph::SignalPtr<dynamicgraph::Matrix, int> articularJacobianSIN;
+
+  using FeatureAbstract::errorSOUT;
+  using FeatureAbstract::jacobianSOUT;
+  using FeatureAbstract::selectionSIN;
+
+  DECLARE_REFERENCE_FUNCTIONS(FeatureVisualPoints);
+
+public:
+  FeatureVisualPoints(const std::string &name);
+  virtual ~FeatureVisualPoints(void) {}
+
+  virtual unsigned int &getDimension(unsigned int &dim, int time);
+
+  virtual dynamicgraph::Vector &computeError(dynamicgraph::Vector &res,
+                                             int time);
+  virtual dynamicgraph::Matrix &computeJacobian(dynamicgraph::Matrix &res,
+                                                int time);
+
+  virtual void display(std::ostream &os) const;
+};
+
+} /* namespace sot */
+} /* namespace dynamicgraph */
+
+#endif // #ifndef __SOT_FEATURE_VISUALPOINTS_HH__
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2020,
+ * CNRS/AIST
+ *
+ */
+
+#ifndef __SOT_FILTER_BANK_HH__
+#define __SOT_FILTER_BANK_HH__
+
+/* --------------------------------------------------------------------- */
+/* --- API ------------------------------------------------------------- */
+/* --------------------------------------------------------------------- */
+
+#if defined(WIN32)
+#if defined(filter_bank_EXPORTS)
+#define SOTFILTERBANK_EXPORT __declspec(dllexport)
+#else
+#define SOTFILTERBANK_EXPORT __declspec(dllimport)
+#endif
+#else
+#define SOTFILTERBANK_EXPORT
+#endif
+
+/* --------------------------------------------------------------------- */
+/* --- INCLUDE --------------------------------------------------------- */
+/* --------------------------------------------------------------------- */
+
+#include <dynamic-graph/all-signals.h>
+#include <dynamic-graph/entity.h>
+#include <dynamic-graph/linear-algebra.h>
+
+#include <string>
+#include <vector>
+
+namespace dynamicgraph {
+namespace sot {
+
+/** \addtogroup Filters
+    \section subsec_filterbank FilterBank
+  This entity gathers many exponential moving averages (as ExpMovingAvg)
+  and finite difference derivatives (as Derivator<Vector>) in a single
+  entity.
+
+  Each filter is a channel added by command addAverage or addDerivative.
+  A channel named "name" creates the input signal sin_name and the output
+  signal sout_name. The states of all the channels are stored contiguously,
+  one buffer per kind of filter, and are updated in a single vectorized
+  pass per time step with per channel coefficients:
+  \f[ avg = \alpha\ avg + (1 - \alpha)\ x \f]
+  \f[ dx = (x - x_{prev}) / dt \f]
+  As Derivator, a derivative is zero at the first time step of its channel.
+  */
+class SOTFILTERBANK_EXPORT FilterBank : public Entity {
+  DYNAMIC_GRAPH_ENTITY_DECL();
+
+public:
+  typedef SignalPtr<Vector, int> SignalIn_t;
+  typedef SignalTimeDependent<Vector, int> SignalOut_t;
+
+  FilterBank(const std::string &name);
+  virtual ~FilterBank(void);
+
+  virtual std::string getDocString() const;
+
+  /// Add an exponential moving average of a vector of the given size.
+  void addAverage(const std::string &name, const int &size,
+                  const double &alpha);
+  /// Add a finite difference derivative of a vector of the given size.
+  void addDerivative(const std::string &name, const int &size,
+                     const double &timestep);
+  void setAlpha(const std::string &name, const double &alpha);
+  void setTimestep(const std::string &name, const double &timestep);
+
+  /// Update all the channels at once.
+  SignalTimeDependent<int, int> bankSINTERN;
+
+protected:
+  struct Channel {
+    std::string name;
+    bool derivative;
+    /// Position of the channel in the buffers of its kind.
+    Eigen::Index offset;
+    Eigen::Index size;
+    SignalIn_t *sin;
+    SignalOut_t *sout;
+  };
+
+  Channel &addChannel(const std::string &name, const int &size,
+                      const bool isDerivative);
+  Channel &getChannel(const std::string &name);
+
+  int &computeBank(int &dummy, const int &time);
+  Vector &computeOutput(Vector &res, const int &time, const std::size_t i);
+
+  std::vector<Channel> channels;
+  /// Derivative channels not computed yet, whose previous input is set to
+  /// their first input.
+  std::vector<std::size_t> newDerivatives;
+
+  /// Exponential moving averages: input, state, alpha and 1 - alpha.
+  Vector averageInput, average, alpha, oneMinusAlpha;
+  /// Derivatives: input, previous input, derivative and 1 / dt.
+  Vector derivativeInput, derivativeMemory, derivative, invTimestep;
+};
+
+} /* namespace sot */
+} /* namespace dynamicgraph */
+
+#endif /* #ifndef __SOT_FILTER_BANK_HH__ */
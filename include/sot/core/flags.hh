@@ -15,9 +15,13 @@
 /* --------------------------------------------------------------------- */
 
 /* STD */
+#include <cassert>
 #include <ostream>
 #include <vector>
 
+/* Eigen */
+#include <Eigen/Core>
+
 /* SOT */
 #include "sot/core/api.hh"
 #include <dynamic-graph/signal-caster.h>
@@ -29,11 +33,28 @@
 namespace dynamicgraph {
 namespace sot {
 
+/*!
+  \brief Bit set used to select the components of a feature or a signal.
+
+  The list of the selected indices is computed on demand and cached in the
+  object, so that the selection held by a signal is only scanned once
+  between two modifications. Use gatherRows and scatterRows to copy the
+  selected rows of a matrix instead of testing each flag.
+ */
 class SOT_CORE_EXPORT Flags {
+public:
+  typedef std::vector<Eigen::Index> Indices_t;
+
 protected:
   std::vector<bool> flags;
   bool outOfRangeFlag;
 
+  /// Cache of selectedIndices, valid if selectedSize is not negative.
+  mutable Indices_t selected;
+  mutable Eigen::Index selectedSize;
+
+  void invalidate(void) { selectedSize = -1; }
+
 public:
   Flags(const bool &b = false);
   Flags(const char *flags);
@@ -56,6 +77,45 @@ public:
 
   void unset(const unsigned int &i);
   void set(const unsigned int &i);
+
+  /// Indices of the selected elements among the first \c size ones.
+  const Indices_t &selectedIndices(const Eigen::Index &size) const;
+  /// Number of selected elements among the first \c size ones.
+  Eigen::Index count(const Eigen::Index &size) const {
+    return static_cast<Eigen::Index>(selectedIndices(size).size());
+  }
+
+  /// Copy the selected rows of \c in into \c out.
+  template <typename In, typename Out>
+  void gatherRows(const Eigen::MatrixBase<In> &in,
+                  Eigen::PlainObjectBase<Out> &out) const {
+    const Indices_t &idx = selectedIndices(in.rows());
+    out.resize(static_cast<Eigen::Index>(idx.size()), in.cols());
+    for (std::size_t k = 0; k < idx.size(); ++k)
+      out.row(static_cast<Eigen::Index>(k)) = in.row(idx[k]);
+  }
+
+  /// Copy the selected columns of \c in into \c out.
+  template <typename In, typename Out>
+  void gatherCols(const Eigen::MatrixBase<In> &in,
+                  Eigen::PlainObjectBase<Out> &out) const {
+    const Indices_t &idx = selectedIndices(in.cols());
+    out.resize(in.rows(), static_cast<Eigen::Index>(idx.size()));
+    for (std::size_t k = 0; k < idx.size(); ++k)
+      out.col(static_cast<Eigen::Index>(k)) = in.col(idx[k]);
+  }
+
+  /// Copy the rows of \c in into the selected rows of \c out.
+  /// The other rows of \c out are left unchanged.
+  template <typename In, typename Out>
+  void scatterRows(const Eigen::MatrixBase<In> &in,
+                   const Eigen::MatrixBase<Out> &out) const {
+    Eigen::MatrixBase<Out> &o = const_cast<Eigen::MatrixBase<Out> &>(out);
+    const Indices_t &idx = selectedIndices(o.rows());
+    assert(in.rows() == static_cast<Eigen::Index>(idx.size()));
+    for (std::size_t k = 0; k < idx.size(); ++k)
+      o.row(idx[k]) = in.row(static_cast<Eigen::Index>(k));
+  }
 };
 
 } // namespace sot
@@ -11,7 +11,7 @@
 
 #include <list>
 
-#include <deque>
+#include <vector>
 
 // Maal
 #include <dynamic-graph/linear-algebra.h>
@@ -22,6 +22,8 @@
 #include <sot/core/matrix-geometry.hh>
 #include <sot/core/trajectory.hh>
 
+#include <boost/thread/mutex.hpp>
+
 #include <sstream>
 // API
 
@@ -43,6 +45,21 @@ namespace sot {
 /** \brief This object handles trajectory of quantities and publish them as
    signals.
 
+   By default, the entity moves to the next point of the trajectory at each
+   evaluation of the graph. When an interpolation is selected with command
+   setInterpolation, the entity keeps a clock advanced by the time step at
+   each evaluation, starting at the stamp of the first trajectory. A
+   trajectory is played from its stamp, and its points are sampled at
+   their time from start, so that sparse trajectories can be sent.
+
+   The trajectories given by commands initTraj and loadFile are parsed in
+   the thread of the command and posted to the thread evaluating the
+   graph, which takes them at the beginning of the next evaluation without
+   waiting. The settings of commands setInterpolation, setTimeStep and
+   setBlendingWindow are posted the same way. A trajectory read from
+   trajectorySIN is queued when its stamp changes. When the played
+   trajectory changes, the difference between the previous output and the
+   new trajectory is faded out over setBlendingWindow evaluations.
  */
 
 class SOTJOINT_TRAJECTORY_ENTITY_EXPORT SotJointTrajectoryEntity
@@ -54,8 +71,31 @@ public:
   SotJointTrajectoryEntity(const std::string &name);
   virtual ~SotJointTrajectoryEntity() {}
 
+  /// \brief Load a trajectory stored in the binary format of
+  /// Trajectory::serializeBinary and use it as initial trajectory.
   void loadFile(const std::string &name);
 
+  /// \brief Hand a trajectory over to the thread evaluating the graph. The
+  /// storage of trajectory is exchanged with the one of a trajectory
+  /// previously posted or retired by the graph, so that no value is copied
+  /// and the graph does not free memory.
+  void postTrajectory(Trajectory &trajectory);
+
+  /// \brief Select how the trajectory is played: "none" to move to the
+  /// next point at each evaluation, "linear", "cubic" or "quintic" to
+  /// interpolate the points at the time of the clock.
+  void setInterpolation(const std::string &interpolation);
+  std::string getInterpolation() const;
+
+  /// \brief Time between two evaluations of the graph, in seconds, used by
+  /// the interpolation.
+  void setTimeStep(const double &timestep);
+  double getTimeStep() const;
+
+  /// \brief Number of evaluations over which a new trajectory is blended.
+  void setBlendingWindow(const int &blendingWindow);
+  int getBlendingWindow() const;
+
   /// \brief Return the next pose for the legs.
   dynamicgraph::Vector &getNextPosition(dynamicgraph::Vector &pos,
                                         const int &time);
@@ -123,7 +163,7 @@ public:
 
 protected:
   /// \brief Index on the point along the trajectory.
-  std::deque<sot::Trajectory>::size_type index_;
+  std::size_t index_;
 
   /// \brief Keep the starting time as an identifier of the trajector
   timestamp traj_timestamp_;
@@ -143,17 +183,119 @@ protected:
   /// \brief Store the current seq identifier.
   unsigned int seqid_;
 
-  /// \brief Initial state of the trajectory.
+  /// \brief Trajectory parsed by the commands before being posted.
   sot::Trajectory init_traj_;
 
-  /// \brief Queue of trajectories.
-  std::deque<sot::Trajectory> deque_traj_;
+  /// \brief Trajectory posted by postTrajectory, protected by
+  /// postedMutex_.
+  sot::Trajectory posted_traj_;
+  bool posted_;
+  mutable boost::mutex postedMutex_;
+
+  /// \brief Trajectory taken from posted_traj_ by the graph. Once queued,
+  /// it holds the retired trajectory of its slot, which is given back to
+  /// posted_traj_ by the next take.
+  sot::Trajectory taken_traj_;
+
+  /// \brief Settings of the playback.
+  struct Settings {
+    bool timed;
+    Trajectory::Interpolation interpolation;
+    double timestep;
+    int blendingWindow;
+  };
+
+  /// \brief Settings set by the commands, protected by postedMutex_ and
+  /// applied by the graph at the beginning of the next evaluation.
+  Settings posted_settings_;
+  bool settingsPosted_;
+
+  /// \brief Queue of trajectories, stored in a ring of slots starting at
+  /// queueHead_. A slot keeps the storage of its retired trajectory until
+  /// a trajectory is queued in it, so that the graph does not free memory,
+  /// and the ring is only enlarged when all its slots are used.
+  std::vector<sot::Trajectory> queue_;
+  std::size_t queueHead_;
+  std::size_t queueSize_;
+
+  /// \brief Whether the first point of the front trajectory is still to be
+  /// played, when timed_ is not set.
+  bool firstPoint_;
+
+  /// \brief Stamp of the last trajectory queued from trajectorySIN.
+  timestamp inputStamp_;
+  bool inputRead_;
+
+  /// \brief Whether the trajectory is played with the clock.
+  bool timed_;
+
+  /// \brief Interpolation of the points when timed_ is set.
+  Trajectory::Interpolation interpolation_;
+
+  /// \brief Time between two evaluations of the graph, in seconds.
+  double timestep_;
+
+  /// \brief Clock of the timed playback: time since the stamp of the
+  /// front trajectory, in seconds. It is kept relative to this stamp so
+  /// that adding the time step does not round on a time since epoch.
+  double clock_;
+
+  /// \brief Segment of the current trajectory containing the clock.
+  std::size_t segment_;
+
+  /// \brief Interpolated positions.
+  dynamicgraph::Vector sample_;
+
+  /// \brief Number of evaluations over which a new trajectory is blended.
+  int blendingWindow_;
+
+  /// \brief Evaluations since the played trajectory changed.
+  int blendStep_;
+
+  /// \brief Stamp of the played trajectory.
+  timestamp playedStamp_;
+
+  /// \brief Difference between the previous output and the new trajectory.
+  dynamicgraph::Vector blendOffset_;
+
+  /// \brief Positions given to UpdatePoint, blending included.
+  dynamicgraph::Vector output_;
+
+  /// \brief Take the posted trajectory, if any and if the lock is free.
+  bool TakePostedTrajectory();
+
+  /// \brief Apply the posted settings, if any and if the lock is free.
+  void ApplyPostedSettings();
+
+  /// \brief Append a slot to the queue and return it, to be filled with a
+  /// trajectory stamped stamp. The slot may hold a retired trajectory,
+  /// whose storage is reused by a copy or given back by a swap. Return
+  /// NULL if the last trajectory of the queue has this stamp.
+  Trajectory *AppendToQueue(const timestamp &stamp);
+
+  /// \brief Trajectory i of the queue, the front one being 0.
+  Trajectory &QueueAt(const std::size_t i) {
+    return queue_[(queueHead_ + i) % queue_.size()];
+  }
+
+  /// \brief Retire the front trajectory, keeping its storage in its slot.
+  void PopQueueFront();
+
+  /// \brief Blend positions of the trajectory current with the previous
+  /// output if it changed, and update the entity.
+  void BlendAndUpdatePoint(
+      const Trajectory &current,
+      const Eigen::Ref<const dynamicgraph::Vector> &positions);
+
+  /// \brief Update the entity with the positions of the current point.
+  void UpdatePoint(const Eigen::Ref<const dynamicgraph::Vector> &positions);
 
-  /// \brief Update the entity with the current point of the trajectory.
-  void UpdatePoint(const JointTrajectoryPoint &aJTP);
+  /// \brief Update the entity with the next point of the queue.
+  void UpdateTrajectory();
 
-  /// \brief Update the entity with the trajectory aTrajectory.
-  void UpdateTrajectory(const Trajectory &aTrajectory);
+  /// \brief Update the entity with the queue sampled at the time of the
+  /// clock.
+  void UpdateTimedTrajectory();
 
   /// \brief Implements the parsing and the affectation of initial trajectory.
   void setInitTraj(const std::string &os);
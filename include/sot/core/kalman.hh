@@ -16,7 +16,8 @@
 /* --- INCLUDE -------------------------------------------------------------- */
 /* -------------------------------------------------------------------------- */
 
-#include <Eigen/LU>
+#include <Eigen/Cholesky>
+#include <Eigen/QR>
 #include <dynamic-graph/all-signals.h>
 #include <dynamic-graph/entity.h>
 #include <dynamic-graph/linear-algebra.h>
@@ -47,6 +48,26 @@ public:
   static const std::string CLASS_NAME;
   virtual const std::string &getClassName(void) const { return CLASS_NAME; }
 
+  /// Algorithm used to compute the gain and the updated covariance.
+  enum UpdateMode {
+    /// P = P - K H P, gain obtained by a Cholesky solve.
+    UPDATE_STANDARD,
+    /// Joseph form P = (I - K H) P (I - K H)^T + K R K^T.
+    UPDATE_JOSEPH,
+    /// Propagate a Cholesky factor of P with orthogonal transformations.
+    UPDATE_SQUARE_ROOT
+  };
+
+  /// How the components of the measurement vector are processed.
+  enum MeasureProcessing {
+    /// Update with the whole measurement vector at once.
+    PROCESS_BATCH,
+    /// One scalar update per measurement component, R is assumed diagonal.
+    PROCESS_SEQUENTIAL,
+    /// Sequential if R is diagonal, batch otherwise.
+    PROCESS_AUTO
+  };
+
 protected:
   unsigned int size_state;
   unsigned int size_measure;
@@ -58,6 +79,7 @@ public:
   SignalPtr<Matrix, int> modelMeasureSIN;    // H
   SignalPtr<Matrix, int> noiseTransitionSIN; // Q
   SignalPtr<Matrix, int> noiseMeasureSIN;    // R
+  SignalPtr<Matrix, int> measureBufferSIN;   // [y_1 ... y_N]
 
   SignalPtr<Vector, int> statePredictedSIN;            // x_{k|k-1}
   SignalPtr<Vector, int> observationPredictedSIN;      // y_pred = h (x_{k|k-1})
@@ -120,6 +142,21 @@ public:
            "    P   =(I - K  H ) P                        \n"
            "     k|k       k  k   k|k-1                   \n"
            "\n"
+           "  The gain is computed by a Cholesky solve of S, S is never\n"
+           "  inverted. Command setUpdateMode selects how P is updated:\n"
+           "    - standard:   P = (I - K H) P\n"
+           "    - joseph:     P = (I - K H) P (I - K H)^T + K R K^T\n"
+           "    - squareRoot: a Cholesky factor L of P = L L^T is propagated\n"
+           "                  by QR factorizations, P stays positive.\n"
+           "\n"
+           "  Command setMeasureProcessing selects how y is processed:\n"
+           "    - batch:      S is factorized as a whole (default)\n"
+           "    - sequential: R is assumed diagonal and each component of\n"
+           "                  y is processed by a scalar update, no matrix\n"
+           "                  needs to be factorized\n"
+           "    - auto:       sequential when R is diagonal\n"
+           "  Plugging y_buffer requires a sequential processing.\n"
+           "\n"
            "  Signals\n"
            "    - input(vector)::x_pred:  state prediction\n"
            "                                                         ^\n"
@@ -132,25 +169,51 @@ public:
            "                                                 k-1\n"
            "    - input(matrix)::R:       variance of noise v\n"
            "                                                 k\n"
+           "    - input(matrix)::y_buffer: optional, several measures y\n"
+           "                              (one per column) of the same tick\n"
            "    - output(matrix)::P_pred: variance of prediction\n"
            "                                               ^\n"
            "    - output(vector)::x_est:  state estimation x\n"
            "                                                k|k\n";
   }
 
-protected:
-  Matrix &computeVarianceUpdate(Matrix &P_k_k, const int &time);
-  Vector &computeStateUpdate(Vector &x_est, const int &time);
-
   void setStateEstimation(const Vector &x0) {
     stateEstimation_ = x0;
     stateUpdateSOUT.recompute(0);
   }
 
-  void setStateVariance(const Matrix &P0) {
-    stateVariance_ = P0;
-    varianceUpdateSOUT.recompute(0);
-  }
+  void setStateVariance(const Matrix &P0);
+
+  void setUpdateMode(const std::string &mode);
+  std::string getUpdateMode() const;
+
+  void setMeasureProcessing(const std::string &processing);
+  std::string getMeasureProcessing() const;
+
+protected:
+  Matrix &computeVarianceUpdate(Matrix &P_k_k, const int &time);
+  Vector &computeStateUpdate(Vector &x_est, const int &time);
+
+  void predictVariance(const Matrix &F, const Matrix &Q);
+  void computeGain(const Matrix &H, const Matrix &R);
+  void updateVarianceStandard(const Matrix &H, Matrix &Pk_k);
+  void updateVarianceJoseph(const Matrix &H, const Matrix &R, Matrix &Pk_k);
+  void updateVarianceSquareRoot(const Matrix &H, const Matrix &R,
+                                Matrix &Pk_k);
+  void updateVarianceSequential(const Matrix &H, const Matrix &R,
+                                const Matrix::Index nbMeasures, Matrix &Pk_k);
+  bool isSequential(const Matrix &R) const;
+  /// Store in sqrtM a matrix such that sqrtM sqrtM^T = M, M being positive
+  /// semi-definite.
+  void squareRootOf(const Matrix &M, Matrix &sqrtM);
+  /// Same as squareRootOf, unless M equals lastM, of which sqrtM is already
+  /// the square root. lastM is then set to M.
+  void cachedSquareRootOf(const Matrix &M, Matrix &lastM, Matrix &sqrtM);
+
+  UpdateMode updateMode_;
+  MeasureProcessing measureProcessing_;
+  // Whether the last update was sequential
+  bool sequential_;
   // Current state estimation
   // ^
   // x
@@ -178,9 +241,36 @@ protected:
   // Innovation covariance
   Matrix S_;
 
-  // Kalman Gain
+  // Kalman Gain. In sequential processing, column i is the gain of the i-th
+  // scalar update.
   Matrix K_;
 
+  // Preallocated workspace of the update: H P, I - K H, (I - K H) P, K R
+  Matrix HP_;
+  Matrix IKH_;
+  Matrix IKHP_;
+  Matrix KR_;
+  Eigen::LLT<Matrix> lltS_;
+  Eigen::LDLT<Matrix> ldltS_;
+  // Sequential processing: P h^T and L^T h^T
+  Vector Ph_;
+  Vector phi_;
+
+  // Square root mode: lower triangular factor L of P = L L^T
+  Matrix stateVarianceSqrt_;
+  Matrix sqrtQ_;
+  Matrix sqrtR_;
+  // Q and R of which sqrtQ_ and sqrtR_ are the square roots
+  Matrix lastQ_;
+  Matrix lastR_;
+  // L D^{1/2} of the LDLT decomposition in squareRootOf
+  Matrix sqrtWork_;
+  Matrix preArrayPrediction_;
+  Matrix preArrayUpdate_;
+  Eigen::HouseholderQR<Matrix> qrPrediction_;
+  Eigen::HouseholderQR<Matrix> qrUpdate_;
+  Eigen::LDLT<Matrix> ldlt_;
+
 public:
   Kalman(const std::string &name);
   /* --- Entity --- */
@@ -73,6 +73,19 @@ The signals input are:
 as a quaternion</li>
 </ul>
 
+When the IMU runs faster than the graph, the samples received during one
+period of the graph can be given at once, one sample per column:
+<ul>
+<li>m_accelerometer_batchSIN: \f$3 \times N\f$ accelerations</li>
+<li>m_gyroscope_batchSIN: \f$3 \times N\f$ angular velocities</li>
+<li>m_imu_quat_batchSOUT: \f$4 \times N\f$ estimated rotation after each
+sample</li>
+</ul>
+If both batch signals are plugged, they replace m_accelerometerSIN and
+m_gyroscopeSIN, the N samples are integrated in order and m_imu_quatSOUT
+is the rotation after the last one. The timestep given to init is then the
+period of the IMU.
+
 The internal parameters are:
 <ul>
 <li>\f$Beta\f$: Gradient step weight (default to 0.01) </li>
@@ -101,8 +114,14 @@ public:
   DECLARE_SIGNAL_IN(accelerometer, dynamicgraph::Vector);
   /// gx gy gz in rad.s-1
   DECLARE_SIGNAL_IN(gyroscope, dynamicgraph::Vector);
+  /// ax ay az in m.s-2 of N samples, one per column
+  DECLARE_SIGNAL_IN(accelerometer_batch, dynamicgraph::Matrix);
+  /// gx gy gz in rad.s-1 of N samples, one per column
+  DECLARE_SIGNAL_IN(gyroscope_batch, dynamicgraph::Matrix);
   /// Estimated orientation of IMU as a quaternion
   DECLARE_SIGNAL_OUT(imu_quat, dynamicgraph::Vector);
+  /// Estimated orientation of IMU after each sample of the batch
+  DECLARE_SIGNAL_OUT(imu_quat_batch, dynamicgraph::Matrix);
 
 protected:
   /* --- COMMANDS --- */
@@ -113,6 +132,11 @@ protected:
   double invSqrt(double x);
   void madgwickAHRSupdateIMU(double gx, double gy, double gz, double ax,
                              double ay, double az);
+  /// Integrate the samples stored in the columns of gyroscope and
+  /// accelerometer, and store the quaternion after each of them in
+  /// m_quatBatch.
+  void madgwickAHRSupdateIMUBatch(const dynamicgraph::Matrix &gyroscope,
+                                  const dynamicgraph::Matrix &accelerometer);
 
 protected:
   /// true if the entity has been successfully initialized
@@ -123,6 +147,10 @@ protected:
   double m_q0, m_q1, m_q2, m_q3;
   /// sample frequency in Hz
   double m_sampleFreq;
+  /// sample period in s
+  double m_samplePeriod;
+  /// quaternions [q0,q1,q2,q3] after each sample of the last batch
+  dynamicgraph::Matrix m_quatBatch;
 
 }; // class MadgwickAHRS
 } // namespace sot
@@ -37,6 +37,9 @@ public: //   protected:
   SVD_t svd;
   Kernel_t kernel;
 
+  /// Topology version of the task for which the memory was allocated.
+  unsigned int topologyVersion;
+
   void resizeKernel(const Matrix::Index r, const Matrix::Index c) {
     if (kernel.rows() != r || kernel.cols() != c) {
       if (kernelMem.size() < r * c)
@@ -59,9 +62,9 @@ public:
 
   void display(std::ostream &os) const;
 
-private:
   void initMemory(const Matrix::Index nJ, const Matrix::Index mJ);
 
+private:
   Matrix kernelMem;
 };
 
@@ -18,10 +18,11 @@
 #include <dynamic-graph/linear-algebra.h>
 
 /* STD */
+#include <atomic>
 #include <boost/function.hpp>
 #include <fstream>
-#include <list>
 #include <string>
+#include <thread>
 #include <vector>
 
 /* SOT & DG*/
@@ -65,22 +66,91 @@ public:
 
 public:
   sotReader(const std::string n);
-  virtual ~sotReader(void) {}
+  virtual ~sotReader(void);
 
+  /// \brief Append the lines of a file to the data set. The file is mapped
+  /// in memory and each line is parsed when it is played, only the
+  /// selected columns being converted. The records of a binary trace (see
+  /// BinaryTraceHeader) are read as lines, without parsing.
   void load(const std::string &filename);
   void clear(void);
   void rewind(void);
 
+  /// \brief Parse the lines ahead in a thread, in a ring of capacity lines
+  /// which is read without waiting at each evaluation. 0 parses each line
+  /// when it is played. The lines parsed ahead of the previous mode are
+  /// dropped.
+  void setStreaming(const int &capacity);
+
 protected:
-  typedef std::list<std::vector<double> > DataType;
-  DataType dataSet;
-  DataType::const_iterator currentData;
+  /// \brief Content of a file given to load, mapped in memory (copied on
+  /// Windows).
+  struct File {
+    const char *data;
+    std::size_t size;
+    /// \brief Size of the header of a binary trace, 0 for a text file.
+    std::size_t offset;
+    /// \brief Number of values of the records of a binary trace, 0 for a
+    /// text file.
+    std::size_t width;
+  };
+  std::vector<File> files;
+  static void release(const File &file);
+  /// \brief File and beginning of the line currently played, NULL at the
+  /// end of the data set.
+  std::size_t currentFile;
+  const char *currentLine;
   bool iteratorSet;
+  /// \brief Beginning of the values of the current line, which end at the
+  /// first token which is not a number.
+  std::vector<const char *> tokens;
+  /// \brief Values of the current line of a binary trace, NULL for a text
+  /// file.
+  const double *record;
+  std::size_t recordWidth;
+  /// \brief Copy of the last line of a file which does not end with a new
+  /// line, so that it is not parsed past the end of the mapping.
+  std::string lastLine;
 
   int rows, cols;
 
+  /// \brief Move to the next line starting with a number, the first one
+  /// after a rewind, and split its values in tokens or point record to it.
+  bool nextLine(void);
+
+  /// \name Streaming
+  /// When ring is not empty, the lines are parsed by streamThread, which
+  /// owns the current line, and written in ring[ringHead % ring.size()].
+  /// getNextData reads ring[ringTail % ring.size()].
+  /// @{
+  std::vector<dynamicgraph::Vector> ring;
+  std::atomic<std::size_t> ringHead, ringTail;
+  std::atomic<bool> streamStop;
+  std::thread streamThread;
+
+  void startStreaming(void);
+  void stopStreaming(void);
+  void stream(void);
+  /// @}
+
+  /// \name Playing
+  /// getNextData only reads the data while playing is set, counting itself
+  /// in players. The commands which change the data or the ring call
+  /// stopPlaying, which clears playing and waits until no getNextData is in
+  /// progress, then stops the streaming thread, and startPlaying when done.
+  /// @{
+  std::atomic<bool> playing;
+  std::atomic<int> players;
+
+  void stopPlaying(void);
+  void startPlaying(void);
+  /// @}
+
   dynamicgraph::Vector &getNextData(dynamicgraph::Vector &res,
                                     const unsigned int time);
+  /// \brief Write the selected values of the next line in res. Return
+  /// false if there is none.
+  bool playNextLine(const Flags &selection, dynamicgraph::Vector &res);
   dynamicgraph::Matrix &getNextMatrix(dynamicgraph::Matrix &res,
                                       const unsigned int time);
   void resize(const int &nbRow, const int &nbCol);
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2020,
+ * CNRS/AIST
+ *
+ */
+
+#ifndef __SOT_RECORDER_HH__
+#define __SOT_RECORDER_HH__
+
+/* --------------------------------------------------------------------- */
+/* --- API ------------------------------------------------------------- */
+/* --------------------------------------------------------------------- */
+
+#if defined(WIN32)
+#if defined(recorder_EXPORTS)
+#define SOTRECORDER_EXPORT __declspec(dllexport)
+#else
+#define SOTRECORDER_EXPORT __declspec(dllimport)
+#endif
+#else
+#define SOTRECORDER_EXPORT
+#endif
+
+/* --------------------------------------------------------------------- */
+/* --- INCLUDE --------------------------------------------------------- */
+/* --------------------------------------------------------------------- */
+
+#include <dynamic-graph/all-signals.h>
+#include <dynamic-graph/entity.h>
+#include <dynamic-graph/linear-algebra.h>
+
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dynamicgraph {
+namespace sot {
+
+/** This entity records double, vector and matrix signals in a binary trace
+  (see BinaryTraceHeader), which sotReader loads like a text trace.
+
+  Each recorded signal is an input signal added by command addDouble,
+  addVector or addMatrix with a fixed size. When triggerSOUT is evaluated,
+  the values of the inputs are copied in a preallocated ring of records,
+  without any allocation nor formatting. A thread started by command open
+  writes the ring to the file. When the ring is full, the record is dropped
+  and counted (command getDropped).
+  */
+class SOTRECORDER_EXPORT Recorder : public Entity {
+  DYNAMIC_GRAPH_ENTITY_DECL();
+
+public:
+  Recorder(const std::string &name);
+  virtual ~Recorder(void);
+
+  virtual std::string getDocString() const;
+
+  void addDouble(const std::string &name);
+  void addVector(const std::string &name, const int &size);
+  void addMatrix(const std::string &name, const int &rows, const int &cols);
+
+  /// Write the header in the file and start writing the records, the ring
+  /// holding capacity records.
+  void open(const std::string &filename, const int &capacity);
+  /// Write the records left in the ring and close the file.
+  void close(void);
+  int getDropped(void) const;
+
+  /// Record the inputs.
+  SignalTimeDependent<int, int> triggerSOUT;
+
+protected:
+  struct Channel {
+    std::string name;
+    Eigen::Index rows, cols;
+    /// The input of the type of the channel, the others are NULL.
+    SignalPtr<double, int> *doubleSIN;
+    SignalPtr<Vector, int> *vectorSIN;
+    SignalPtr<Matrix, int> *matrixSIN;
+  };
+
+  Channel &addChannel(const std::string &name, const int &rows,
+                      const int &cols);
+
+  int &record(int &dummy, const int &time);
+  /// Copy the inputs in the ring, called by record while recording.
+  void push(const int &time);
+  /// Loop of writeThread.
+  void write(void);
+
+  std::vector<Channel> channels;
+  std::ofstream file;
+
+  /// \name Ring
+  /// Records of the ring, one per column: the time followed by the values of
+  /// the channels. record writes ring.col(ringHead % ring.cols()) and
+  /// writeThread reads ring.col(ringTail % ring.cols()). The ring has no
+  /// column when the file is closed.
+  ///
+  /// The ring is only accessed by record while recording is true. close
+  /// clears recording and waits until no record is in progress
+  /// (recordUsers is 0) before releasing the ring.
+  /// @{
+  Matrix ring;
+  std::atomic<std::size_t> ringHead, ringTail, dropped;
+  std::atomic<bool> recording;
+  std::atomic<int> recordUsers;
+  std::atomic<bool> writeStop;
+  std::thread writeThread;
+  /// @}
+};
+
+} /* namespace sot */
+} /* namespace dynamicgraph */
+
+#endif /* #ifndef __SOT_RECORDER_HH__ */
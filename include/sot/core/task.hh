@@ -19,6 +19,7 @@
 
 /* STD */
 #include <string>
+#include <vector>
 
 /* SOT */
 #include <sot/core/feature-abstract.hh>
@@ -78,6 +79,19 @@ protected:
   FeatureList_t featureList;
   bool withDerivative;
 
+  /// Offsets of the features in the stacked error and Jacobian. The last
+  /// element is the dimension of the task.
+  std::vector<dynamicgraph::Vector::Index> featureOffsets;
+  /// Incremented each time the list of features changes.
+  unsigned int featureListVersion;
+  /// Versions of the list of features and sum of the topology versions of
+  /// the features for which featureOffsets was computed.
+  unsigned int layoutListVersion, layoutFeaturesVersion;
+  unsigned int topologyVersion;
+
+  /// Recompute featureOffsets if the topology of the task changed.
+  void updateLayout(int time);
+
   DYNAMIC_GRAPH_ENTITY_DECL();
 
 public:
@@ -96,6 +110,12 @@ public:
   void setWithDerivative(const bool &s);
   bool getWithDerivative(void);
 
+  /*! \brief Version of the topology of the task, incremented each time the
+    list of features or the dimension of one of them changes. */
+  unsigned int getTopologyVersion(int time);
+  /// Dimension of the task, i.e. the sum of the dimensions of the features.
+  dynamicgraph::Vector::Index getTaskDimension(int time);
+
   /* --- COMPUTATION --- */
   dynamicgraph::Vector &computeError(dynamicgraph::Vector &error, int time);
   VectorMultiBound &computeTaskExponentialDecrease(VectorMultiBound &errorRef,
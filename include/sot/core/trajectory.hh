@@ -27,6 +27,9 @@ namespace sot {
 
 class Trajectory;
 
+/// \brief Regular expression based parser of the textual representation of
+/// a trajectory.
+/// \deprecated Trajectory::deserialize uses a faster single pass parser.
 class RulesJointTrajectory {
 protected:
   Trajectory &TrajectoryToFill_;
@@ -114,13 +117,18 @@ public:
   Header() : seq_(0), stamp_(0, 0), frame_id_("initial_trajectory") {}
 };
 
+/// \brief Point of a trajectory which owns its values. It is used to build
+/// a Trajectory point by point, see Trajectory::addPoint.
 class SOT_CORE_EXPORT JointTrajectoryPoint {
 
 public:
+  JointTrajectoryPoint() : time_from_start_(0.) {}
+
   std::vector<double> positions_;
   std::vector<double> velocities_;
   std::vector<double> accelerations_;
   std::vector<double> efforts_;
+  double time_from_start_;
 
   typedef std::vector<double> vec_ref;
 
@@ -179,6 +187,25 @@ public:
 class SOT_CORE_EXPORT Trajectory {
 
 public:
+  /// \brief Read only view on the values of a point. It refers to the
+  /// columns of the trajectory and is invalidated when they are resized.
+  struct SOT_CORE_EXPORT ConstPoint {
+    ConstPoint(const Trajectory &traj, const Eigen::Index i)
+        : positions_(traj.positions_.col(i)),
+          velocities_(traj.velocities_.col(i)),
+          accelerations_(traj.accelerations_.col(i)),
+          efforts_(traj.efforts_.col(i)),
+          time_from_start_(traj.times_from_start_(i)) {}
+
+    Matrix::ConstColXpr positions_;
+    Matrix::ConstColXpr velocities_;
+    Matrix::ConstColXpr accelerations_;
+    Matrix::ConstColXpr efforts_;
+    double time_from_start_;
+
+    void display(std::ostream &os) const;
+  };
+
   Trajectory();
   Trajectory(const Trajectory &copy);
   virtual ~Trajectory();
@@ -188,9 +215,99 @@ public:
   Header header_;
   double time_from_start_;
 
-  std::vector<JointTrajectoryPoint> points_;
-
+  /// \name Values of the points
+  /// Each quantity is stored in a matrix with one column per point, so that
+  /// a trajectory is copied with four allocations whatever its length. All
+  /// the matrices have the same number of columns. A quantity which is not
+  /// given has no rows.
+  /// @{
+  Matrix positions_;
+  Matrix velocities_;
+  Matrix accelerations_;
+  Matrix efforts_;
+  /// Time from the start of the trajectory of each point, in seconds.
+  Vector times_from_start_;
+  /// @}
+
+  std::size_t nbPoints() const {
+    return static_cast<std::size_t>(positions_.cols());
+  }
+  ConstPoint point(const std::size_t i) const {
+    return ConstPoint(*this, static_cast<Eigen::Index>(i));
+  }
+  /// Quantity i: positions, velocities, accelerations or efforts.
+  Matrix &quantity(const std::size_t i);
+  const Matrix &quantity(const std::size_t i) const;
+
+  /// Append a point at the end of the trajectory.
+  /// \throw ExceptionTools if a quantity of the point does not have the
+  /// size of the previous points.
+  void addPoint(const JointTrajectoryPoint &point);
+  /// Remove all the points.
+  void clearPoints();
+  /// Exchange the contents of two trajectories without copying the values.
+  void swap(Trajectory &other);
+
+  /// \name Interpolation
+  /// The trajectory is sampled at a time from its start, using the times
+  /// from start of the points, which must be strictly increasing. Before
+  /// the first point and after the last one, the positions are constant.
+  /// @{
+  enum Interpolation {
+    /// Linear interpolation of the positions.
+    INTERPOLATION_LINEAR,
+    /// Cubic Hermite interpolation using the velocities.
+    INTERPOLATION_CUBIC,
+    /// Quintic interpolation using the velocities and the accelerations.
+    INTERPOLATION_QUINTIC
+  };
+
+  /// Index k of the segment such that point k is the last one not after t,
+  /// between 0 and nbPoints() - 2, or 0 when there are less than two
+  /// points. The search goes forward from hint when it is not after t, and
+  /// is a binary search otherwise.
+  std::size_t findSegment(const double t, const std::size_t hint) const;
+
+  /// Interpolate the positions at time t. The order of the interpolation is
+  /// lowered when the velocities or the accelerations are not given.
+  /// \param segment hint of findSegment, updated to the segment of t.
+  void interpolatePositions(const double t, const Interpolation interpolation,
+                            std::size_t &segment, Vector &positions) const;
+  /// @}
+
+  /// \brief Fill the trajectory from its textual representation
+  /// (seq,(secs,nsecs),frame_id),(joint_1,...,joint_n),
+  /// (((positions),(velocities),(accelerations),(efforts),time),...).
+  ///
+  /// The time from start of a point, in seconds, is optional and defaults
+  /// to 0. The text is read in a single pass. Each quantity must have the
+  /// same size for all the points.
+  /// \throw ExceptionTools if the text is malformed.
+  int deserialize(const std::string &text);
   int deserialize(std::istringstream &is);
+
+  /// \name Binary representation
+  /// The binary representation is made of:
+  /// - a header of 64 bytes: the magic string "SOTTRAJ", the byte order
+  ///   mark 0x01020304, the version of the format, seq, the number of
+  ///   joints, secs, nsecs, the number of points, the size of the block of
+  ///   names and the number of rows of the positions, velocities,
+  ///   accelerations and efforts,
+  /// - the block of names: frame_id and the joint names, each terminated by
+  ///   a null character, padded with zeros to a multiple of 8 bytes,
+  /// - the matrices of the positions, velocities, accelerations and efforts
+  ///   as doubles in column major order, that is point after point,
+  /// - the times from start of the points as doubles.
+  ///
+  /// Integers and doubles use the byte order of the machine.
+  /// @{
+  void serializeBinary(std::ostream &os) const;
+  /// \throw ExceptionTools if data is not a valid binary representation.
+  void deserializeBinary(const char *data, const std::size_t size);
+  void saveBinaryFile(const std::string &filename) const;
+  /// Map the file in memory and deserialize it.
+  void loadBinaryFile(const std::string &filename);
+  /// @}
   void display(std::ostream &) const;
 };
 } // namespace sot
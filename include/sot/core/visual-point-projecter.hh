@@ -39,6 +39,19 @@ namespace sot {
 /* --- CLASS ----------------------------------------------------------- */
 /* --------------------------------------------------------------------- */
 
+/*!
+  Projects a 3D point, expressed in the world frame, in the image plane of
+  the camera whose pose is given by signal transfo.
+
+  In cached mode (command setCached), the projection is only recomputed
+  when the value of point3D or transfo changes, which typically happens
+  at the rate of the camera. In between, the point in the camera frame is
+  extrapolated linearly from its last two updates, and its projection is
+  extrapolated with the Jacobian of the projection at the last update.
+  The extrapolation stops after a horizon (command
+  setExtrapolationHorizon), by default the interval between the last two
+  updates, and the point is then held until the inputs change again.
+ */
 class SOTVISUALPOINTPROJECTER_EXPORT VisualPointProjecter
     : public ::dynamicgraph::Entity,
       public ::dynamicgraph::EntityHelper<VisualPointProjecter> {
@@ -51,6 +64,10 @@ public: /* --- ENTITY INHERITANCE --- */
   virtual void display(std::ostream &os) const;
   virtual const std::string &getClassName(void) const { return CLASS_NAME; }
 
+public: /* --- COMMANDS --- */
+  void setCached(const bool &cached);
+  void setExtrapolationHorizon(const int &horizon);
+
 public: /* --- SIGNALS --- */
   DECLARE_SIGNAL_IN(point3D, dynamicgraph::Vector);
   DECLARE_SIGNAL_IN(transfo, MatrixHomogeneous);
@@ -59,6 +76,31 @@ public: /* --- SIGNALS --- */
   DECLARE_SIGNAL_OUT(depth, double);
   DECLARE_SIGNAL_OUT(point2D, dynamicgraph::Vector);
 
+private:
+  /// Update the cache if the inputs changed.
+  /// \return true if the projection has been recomputed.
+  bool updateCache(int iter);
+
+  Eigen::Vector3d project(const dynamicgraph::Vector &p3,
+                          const MatrixHomogeneous &M) const;
+
+  bool m_cached;
+  bool m_cacheInitialized;
+  /// Time of the last update of the cache, and time since the update
+  /// before.
+  int m_lastUpdate, m_updatePeriod;
+  /// Maximal number of iterations of the extrapolation, or 0 for
+  /// m_updatePeriod.
+  int m_extrapolationHorizon;
+  /// Inputs of the last update.
+  Eigen::Vector3d m_point3D;
+  MatrixHomogeneous m_transfo;
+  /// Point in the camera frame at the last update and its velocity.
+  Eigen::Vector3d m_gaze, m_gazeVelocity;
+  /// Projection of m_gaze and its Jacobian wrt the point in camera frame.
+  Eigen::Vector2d m_point2D;
+  Eigen::Matrix<double, 2, 3> m_projectionJacobian;
+
 }; // class VisualPointProjecter
 
 } // namespace sot
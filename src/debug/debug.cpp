@@ -7,9 +7,17 @@
  *
  */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <ios>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <sot/core/debug.hh>
+#include <thread>
+#include <vector>
 
 using namespace dynamicgraph::sot;
 
@@ -41,20 +49,323 @@ __sotDebug_init __sotDebug_initialisator;
 
 #endif // VP_DEBUG
 
+/* --- LEVELS ------------------------------------------------------------ */
+
+namespace {
+#ifdef VP_DEBUG
+// The file is opened at initialization.
+const int initialLevel = std::numeric_limits<int>::max();
+#else  // VP_DEBUG
+const int initialLevel = -1;
+#endif // VP_DEBUG
+
+/// Levels set for each module.
+int levels[DEBUG_MODULE_COUNT] = {
+    std::numeric_limits<int>::max(), std::numeric_limits<int>::max(),
+    std::numeric_limits<int>::max(), std::numeric_limits<int>::max(),
+    std::numeric_limits<int>::max()};
+
+void updateWrittenLevels(void) {
+  const bool open = debugfile.is_open() && debugfile.good();
+  for (int m = 0; m < DEBUG_MODULE_COUNT; ++m)
+    DebugTrace::writtenLevels[m] = open ? levels[m] : -1;
+}
+} // namespace
+
+std::atomic<int> DebugTrace::writtenLevels[DEBUG_MODULE_COUNT] = {
+    {initialLevel}, {initialLevel}, {initialLevel}, {initialLevel},
+    {initialLevel}};
+
+void DebugTrace::setLevel(const DebugModule module, const int level) {
+  levels[module] = level;
+  updateWrittenLevels();
+}
+
+int DebugTrace::getLevel(const DebugModule module) { return levels[module]; }
+
 } /* namespace sot */
 } /* namespace dynamicgraph */
 
+/* --- REAL-TIME BACKEND ------------------------------------------------- */
+
+namespace dynamicgraph {
+namespace sot {
+namespace {
+/// Message written in a ring, formatted by the thread which writes it to
+/// the debug file.
+struct Record {
+  const char *file, *function;
+  int line;
+  bool error;
+  /// Time since epoch, in seconds.
+  double time;
+  std::size_t size;
+  char text[DebugTrace::SIZE];
+};
+
+/// Stream buffer writing in the text of a record, the characters past its
+/// end being discarded. The last character of the text is kept for the end
+/// of line.
+class RecordBuffer : public std::streambuf {
+public:
+  void reset(char *begin, const std::size_t size) {
+    setp(begin, begin + size);
+  }
+  std::size_t size(void) const {
+    return static_cast<std::size_t>(pptr() - pbase());
+  }
+};
+} // namespace
+
+/// Records of a thread: the thread writes records[head % records.size()]
+/// and the writing thread reads records[tail % records.size()].
+struct DebugRing {
+  explicit DebugRing(const std::size_t capacity)
+      : records(capacity), head(0), tail(0), dropped(0), busy(false),
+        stream(&buffer), droppedStream(NULL) {}
+
+  std::vector<Record> records;
+  std::atomic<std::size_t> head, tail, dropped;
+  /// Whether a record is being written, waited for by stopRealTime.
+  std::atomic<bool> busy;
+  RecordBuffer buffer;
+  std::ostream stream;
+  /// Stream of the dropped messages, which is always bad.
+  std::ostream droppedStream;
+};
+
+namespace {
+std::atomic<bool> realTime(false);
+std::atomic<bool> realTimeStop(false);
+std::thread realTimeThread;
+std::size_t realTimeCapacity = 256;
+
+/// Rings of all the threads, kept until they are written after the end of
+/// their thread.
+std::mutex ringsMutex;
+std::vector<std::shared_ptr<DebugRing> > rings;
+thread_local std::shared_ptr<DebugRing> threadRing;
+
+/// Lock of the debug file, held while the rings are written and while a
+/// message is written directly, for instance once realTime is cleared and
+/// before the last write of the rings. It is recursive for a message
+/// written in a message.
+std::recursive_mutex fileMutex;
+
+DebugRing &currentRing(void) {
+  if (!threadRing) {
+    threadRing = std::make_shared<DebugRing>(realTimeCapacity);
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    rings.push_back(threadRing);
+  }
+  return *threadRing;
+}
+
+/// \return whether records were written.
+bool writeRecords(DebugRing &ring, std::ostream &os) {
+  std::size_t tail = ring.tail.load(std::memory_order_relaxed);
+  const std::size_t head = ring.head.load(std::memory_order_acquire);
+  const bool written = tail != head;
+  char time[32];
+  for (; tail != head; ++tail) {
+    const Record &r = ring.records[tail % ring.records.size()];
+    std::snprintf(time, sizeof(time), "[%.6f] ", r.time);
+    os << time;
+    if (r.file != NULL) {
+      if (r.error)
+        os << "\t!! ";
+      os << r.file << ": " << r.function << "(#" << r.line << ") :";
+    }
+    os.write(r.text, static_cast<std::streamsize>(r.size));
+  }
+  ring.tail.store(tail, std::memory_order_release);
+
+  const std::size_t dropped = ring.dropped.exchange(0);
+  if (dropped != 0)
+    os << "# " << dropped << " messages dropped" << std::endl;
+  return written || dropped != 0;
+}
+
+bool isEmpty(const std::shared_ptr<DebugRing> &ring) {
+  return ring->head.load(std::memory_order_acquire) ==
+         ring->tail.load(std::memory_order_relaxed);
+}
+
+/// Rings of the threads which ended, once they are written.
+bool isUnused(const std::shared_ptr<DebugRing> &ring) {
+  return ring.use_count() == 1 && isEmpty(ring);
+}
+
+bool isBusy(const std::shared_ptr<DebugRing> &ring) { return ring->busy; }
+
+void writeLocation(std::ostream &os, const char *file, const char *function,
+                   const int line, const bool error) {
+  if (file == NULL)
+    return;
+  if (error)
+    os << "\t!! ";
+  os << file << ": " << function << "(#" << line << ") :";
+}
+
+void writeLoop(void) {
+  std::vector<std::shared_ptr<DebugRing> > current;
+  for (;;) {
+    // Read before the rings, so that all the records are written on stop.
+    const bool stop = realTimeStop.load(std::memory_order_acquire);
+    {
+      std::lock_guard<std::mutex> lock(ringsMutex);
+      current = rings;
+    }
+    {
+      std::lock_guard<std::recursive_mutex> lock(fileMutex);
+      bool written = false;
+      for (std::size_t i = 0; i < current.size(); ++i)
+        written = writeRecords(*current[i], debugfile) || written;
+      if (written)
+        debugfile.flush();
+    }
+    current.clear();
+    {
+      std::lock_guard<std::mutex> lock(ringsMutex);
+      rings.erase(std::remove_if(rings.begin(), rings.end(), isUnused),
+                  rings.end());
+    }
+
+    if (stop)
+      return;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+/// Stop the real-time backend at exit, before the debug file is closed.
+struct RealTimeStop {
+  ~RealTimeStop() { DebugTrace::stopRealTime(); }
+} realTimeStopAtExit;
+} // namespace
+
+DebugRecord::DebugRecord(DebugTrace &flow, const char *file,
+                         const char *function, const int line,
+                         const bool error)
+    : stream_(&flow.outputbuffer), ring_(NULL), locked_(false) {
+  if (!realTime.load(std::memory_order_relaxed)) {
+    fileMutex.lock();
+    locked_ = true;
+    writeLocation(*stream_, file, function, line, error);
+    return;
+  }
+
+  DebugRing &ring = currentRing();
+  const std::size_t head = ring.head.load(std::memory_order_relaxed);
+  // A message written while another one is being written, for instance by
+  // a function called in the message, is dropped too.
+  if (ring.busy.load(std::memory_order_relaxed) ||
+      head - ring.tail.load(std::memory_order_acquire) == ring.records.size()) {
+    ring.dropped.fetch_add(1, std::memory_order_relaxed);
+    stream_ = &ring.droppedStream;
+    return;
+  }
+  // stopRealTime clears realTime, then waits for the busy rings: either the
+  // record is seen busy and written by the last write of the rings, or
+  // realTime is seen false here and the message is written directly.
+  ring.busy = true;
+  if (!realTime) {
+    ring.busy.store(false, std::memory_order_release);
+    fileMutex.lock();
+    locked_ = true;
+    writeLocation(*stream_, file, function, line, error);
+    return;
+  }
+
+  Record &r = ring.records[head % ring.records.size()];
+  r.file = file;
+  r.function = function;
+  r.line = line;
+  r.error = error;
+  r.time = std::chrono::duration<double>(
+               std::chrono::system_clock::now().time_since_epoch())
+               .count();
+  ring.buffer.reset(r.text, sizeof(r.text) - 1);
+  ring.stream.clear();
+  stream_ = &ring.stream;
+  ring_ = &ring;
+}
+
+DebugRecord::~DebugRecord(void) {
+  if (locked_)
+    fileMutex.unlock();
+  if (ring_ == NULL)
+    return;
+  const std::size_t head = ring_->head.load(std::memory_order_relaxed);
+  Record &r = ring_->records[head % ring_->records.size()];
+  r.size = ring_->buffer.size();
+  // A truncated message, whose end of line is discarded, still ends its
+  // line.
+  if (r.size == 0 || r.text[r.size - 1] != '\n')
+    r.text[r.size++] = '\n';
+  ring_->head.store(head + 1, std::memory_order_release);
+  ring_->busy.store(false, std::memory_order_release);
+}
+
+} /* namespace sot */
+} /* namespace dynamicgraph */
+
+void DebugTrace::startRealTime(const std::size_t capacity) {
+  stopRealTime();
+  realTimeCapacity = std::max<std::size_t>(capacity, 1);
+  realTimeStop = false;
+  realTimeThread = std::thread(&writeLoop);
+  realTime = true;
+}
+
+void DebugTrace::stopRealTime(void) {
+  if (!realTimeThread.joinable())
+    return;
+  // The new messages are written directly, under the lock of the file, and
+  // the records being written are committed before the last write of the
+  // rings.
+  realTime = false;
+  {
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    while (std::any_of(rings.begin(), rings.end(), isBusy))
+      std::this_thread::yield();
+  }
+  realTimeStop = true;
+  realTimeThread.join();
+}
+
+bool DebugTrace::isRealTime(void) {
+  return realTime.load(std::memory_order_relaxed);
+}
+
+void DebugTrace::registerThread(void) { currentRing(); }
+
+/* --- FILE -------------------------------------------------------------- */
+
 void DebugTrace::openFile(const char *filename) {
-  if (debugfile.good() && debugfile.is_open())
-    debugfile.close();
-  debugfile.clear();
-  debugfile.open(filename, std::ios::trunc & std::ios::out);
+  // The file is not written by the real-time backend while it is opened.
+  const bool restart = isRealTime();
+  stopRealTime();
+  {
+    std::lock_guard<std::recursive_mutex> lock(fileMutex);
+    if (debugfile.good() && debugfile.is_open())
+      debugfile.close();
+    debugfile.clear();
+    debugfile.open(filename, std::ios::trunc & std::ios::out);
+  }
+  updateWrittenLevels();
+  if (restart)
+    startRealTime(realTimeCapacity);
 }
 
 void DebugTrace::closeFile(const char *) {
-  if (debugfile.good() && debugfile.is_open())
-    debugfile.close();
-  debugfile.setstate(std::ios::failbit);
+  stopRealTime();
+  {
+    std::lock_guard<std::recursive_mutex> lock(fileMutex);
+    if (debugfile.good() && debugfile.is_open())
+      debugfile.close();
+    debugfile.setstate(std::ios::failbit);
+  }
+  updateWrittenLevels();
 }
 
 namespace dynamicgraph {
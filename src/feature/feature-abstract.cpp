@@ -37,9 +37,10 @@ FeatureAbstract::FeatureAbstract(const std::string &name)
                    selectionSIN,
                    "sotFeatureAbstract(" + name +
                        ")::output(matrix)::jacobian"),
-      dimensionSOUT(boost::bind(&FeatureAbstract::getDimension, this, _1, _2),
-                    selectionSIN,
-                    "sotFeatureAbstract(" + name + ")::output(uint)::dim") {
+      dimensionSOUT(
+          boost::bind(&FeatureAbstract::computeDimension, this, _1, _2),
+          selectionSIN, "sotFeatureAbstract(" + name + ")::output(uint)::dim"),
+      topologyVersion(0), lastDimension(0) {
   selectionSIN = true;
   signalRegistration(selectionSIN << errorSOUT << jacobianSOUT
                                   << dimensionSOUT);
@@ -61,6 +62,20 @@ void FeatureAbstract::initCommands(void) {
                  "(feature name)."));
 }
 
+unsigned int &FeatureAbstract::computeDimension(unsigned int &res, int time) {
+  getDimension(res, time);
+  if (topologyVersion == 0 || res != lastDimension) {
+    lastDimension = res;
+    ++topologyVersion;
+  }
+  return res;
+}
+
+void FeatureAbstract::topologyChanged(void) {
+  ++topologyVersion;
+  dimensionSOUT.setReady();
+}
+
 void FeatureAbstract::featureRegistration(void) {
   PoolStorage::getInstance()->registerFeature(name, this);
 }
@@ -11,6 +11,8 @@
 /* --- INCLUDE --------------------------------------------------------- */
 /* --------------------------------------------------------------------- */
 
+#include <algorithm>
+
 /* --- SOT --- */
 #include <sot/core/debug.hh>
 #include <sot/core/exception-feature.hh>
@@ -67,10 +69,7 @@ unsigned int &FeatureGeneric::getDimension(unsigned int &dim, int time) {
   if (dimensionDefault == 0)
     dimensionDefault = errorSIN.access(time).size();
 
-  dim = 0;
-  for (unsigned int i = 0; i < dimensionDefault; ++i)
-    if (fl(i))
-      dim++;
+  dim = static_cast<unsigned int>(fl.count(dimensionDefault));
 
   sotDEBUG(25) << "# Out }" << endl;
   return dim;
@@ -81,8 +80,6 @@ Vector &FeatureGeneric::computeError(Vector &res, int time) {
   const Flags &fl = selectionSIN.access(time);
   const int &dim = dimensionSOUT(time);
 
-  unsigned int curr = 0;
-  res.resize(dim);
   if (err.size() < dim) {
     SOT_THROW ExceptionFeature(
         ExceptionFeature::UNCOMPATIBLE_SIZE,
@@ -94,10 +91,13 @@ Vector &FeatureGeneric::computeError(Vector &res, int time) {
   sotDEBUG(15) << "Err = " << err;
   sotDEBUG(25) << "Dim = " << dim << endl;
 
+  const Flags::Indices_t &selected = fl.selectedIndices(err.size());
+  const bool full = (selected.size() == static_cast<std::size_t>(err.size()));
+
   if (isReferenceSet()) {
     const Vector &errDes = getReference()->errorSIN(time);
     sotDEBUG(15) << "Err* = " << errDes;
-    if (errDes.size() < dim) {
+    if (errDes.size() < dim || (full && errDes.size() < err.size())) {
       SOT_THROW ExceptionFeature(
           ExceptionFeature::UNCOMPATIBLE_SIZE,
           "Error: dimension uncompatible with des->errorIN size."
@@ -105,14 +105,19 @@ Vector &FeatureGeneric::computeError(Vector &res, int time) {
           getName().c_str());
     }
 
-    for (int i = 0; i < err.size(); ++i)
-      if (fl(i))
-        if (fl(i))
-          res(curr++) = err(i) - errDes(i);
+    if (full) {
+      res = err - errDes.head(err.size());
+    } else {
+      res.resize(static_cast<Vector::Index>(selected.size()));
+      for (std::size_t k = 0; k < selected.size(); ++k)
+        res(static_cast<Vector::Index>(k)) =
+            err(selected[k]) - errDes(selected[k]);
+    }
+  } else if (full) {
+    /* Passthrough: a single contiguous copy of the input. */
+    res = err;
   } else {
-    for (int i = 0; i < err.size(); ++i)
-      if (fl(i))
-        res(curr++) = err(i);
+    fl.gatherRows(err, res);
   }
 
   return res;
@@ -125,15 +130,23 @@ Matrix &FeatureGeneric::computeJacobian(Matrix &res, int time) {
   const Flags &fl = selectionSIN.access(time);
   const unsigned int &dim = dimensionSOUT(time);
 
-  unsigned int curr = 0;
-  res.resize(dim, Jac.cols());
+  const Matrix::Index nbr = std::min(Jac.rows(), dimensionDefault);
 
-  for (unsigned int i = 0; curr < dim; ++i)
-    if (fl(i)) {
-      for (int j = 0; j < Jac.cols(); ++j)
-        res(curr, j) = Jac(i, j);
-      curr++;
-    }
+  if (nbr < static_cast<Matrix::Index>(dim)) {
+    SOT_THROW ExceptionFeature(
+        ExceptionFeature::UNCOMPATIBLE_SIZE,
+        "Error: dimension uncompatible with jacobianIN size."
+        " (while considering feature <%s>).",
+        getName().c_str());
+  }
+
+  /* Passthrough: when all the rows are selected, the input is copied as a
+   * whole instead of row by row. */
+  if (Jac.rows() == static_cast<Matrix::Index>(dim) &&
+      fl.count(nbr) == nbr)
+    res = Jac;
+  else
+    fl.gatherRows(Jac.topRows(nbr), res);
 
   sotDEBUGOUT(15);
   return res;
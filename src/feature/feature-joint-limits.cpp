@@ -47,6 +47,7 @@ FeatureJointLimits::FeatureJointLimits(const string &fName)
   errorSOUT.addDependency(jointSIN);
   errorSOUT.addDependency(upperJlSIN);
   errorSOUT.addDependency(lowerJlSIN);
+  jacobianSOUT.addDependency(widthJlSINTERN);
 
   signalRegistration(jointSIN << upperJlSIN << lowerJlSIN << widthJlSINTERN);
 
@@ -75,11 +76,7 @@ unsigned int &FeatureJointLimits::getDimension(unsigned int &dim, int time) {
 
   const Flags &fl = selectionSIN.access(time);
   const Matrix::Index NBJL = upperJlSIN.access(time).size();
-
-  dim = 0;
-  for (Matrix::Index i = 0; i < NBJL; ++i)
-    if (fl(static_cast<int>(i)))
-      dim++;
+  dim = static_cast<unsigned int>(fl.count(NBJL));
 
   sotDEBUG(25) << "# Out }" << endl;
   return dim;
@@ -88,14 +85,9 @@ unsigned int &FeatureJointLimits::getDimension(unsigned int &dim, int time) {
 Vector &FeatureJointLimits::computeWidthJl(Vector &res, const int &time) {
   sotDEBUGIN(15);
 
-  const Vector UJL = upperJlSIN.access(time);
-  const Vector LJL = lowerJlSIN.access(time);
-  const Vector::Index SIZE = UJL.size();
-  res.resize(SIZE);
-
-  for (Vector::Index i = 0; i < SIZE; ++i) {
-    res(i) = UJL(i) - LJL(i);
-  }
+  const Vector &UJL = upperJlSIN.access(time);
+  const Vector &LJL = lowerJlSIN.access(time);
+  res = UJL - LJL;
 
   sotDEBUGOUT(15);
   return res;
@@ -107,24 +99,19 @@ Vector &FeatureJointLimits::computeWidthJl(Vector &res, const int &time) {
 Matrix &FeatureJointLimits::computeJacobian(Matrix &J, int time) {
   sotDEBUG(15) << "# In {" << endl;
 
-  const unsigned int SIZE = dimensionSOUT.access(time);
-  const Vector q = jointSIN.access(time);
-  const Flags &fl = selectionSIN(time);
-  // const unsigned int SIZE_FF=SIZE+freeFloatingSize;
-  const Vector::Index SIZE_TOTAL = q.size();
-  const Vector WJL = widthJlSINTERN.access(time);
-  J.resize(SIZE, SIZE_TOTAL);
-  J.setZero();
-
-  unsigned int idx = 0;
-  for (unsigned int i = 0; i < SIZE_TOTAL; ++i) {
-    if (fl(i)) {
-      if (fabs(WJL(i)) > 1e-3)
-        J(idx, i) = 1 / WJL(i);
-      else
-        J(idx, i) = 1.;
-      idx++;
-    }
+  const Vector::Index SIZE_TOTAL = jointSIN.access(time).size();
+  const Vector &WJL = widthJlSINTERN.access(time);
+  const Flags::Indices_t &selected =
+      selectionSIN(time).selectedIndices(SIZE_TOTAL);
+  const Vector::Index SIZE = static_cast<Vector::Index>(selected.size());
+
+  /* J is one of the two buffers of jacobianSOUT, which may have been
+   * computed with another selection: it is always cleared. */
+  J.setZero(SIZE, SIZE_TOTAL);
+
+  for (Vector::Index k = 0; k < SIZE; ++k) {
+    const Vector::Index i = selected[k];
+    J(k, i) = (fabs(WJL(i)) > 1e-3) ? 1 / WJL(i) : 1.;
   }
   //   if( 0!=freeFloatingIndex )
   //     for( unsigned int i=0;i<freeFloatingIndex;++i )
@@ -149,13 +136,14 @@ Matrix &FeatureJointLimits::computeJacobian(Matrix &J, int time) {
 Vector &FeatureJointLimits::computeError(Vector &error, int time) {
   sotDEBUGIN(15);
 
-  const Flags &fl = selectionSIN(time);
-  const Vector q = jointSIN.access(time);
-  const Vector UJL = upperJlSIN.access(time);
-  const Vector LJL = lowerJlSIN.access(time);
-  const Vector WJL = widthJlSINTERN.access(time);
-  const int SIZE = dimensionSOUT.access(time);
+  const Vector &q = jointSIN.access(time);
+  const Vector &UJL = upperJlSIN.access(time);
+  const Vector &LJL = lowerJlSIN.access(time);
+  const Vector &WJL = widthJlSINTERN.access(time);
   const Vector::Index SIZE_TOTAL = q.size();
+  const Flags::Indices_t &selected =
+      selectionSIN(time).selectedIndices(SIZE_TOTAL);
+  const Vector::Index SIZE = static_cast<Vector::Index>(selected.size());
 
   sotDEBUG(25) << "q = " << q << endl;
   sotDEBUG(25) << "ljl = " << LJL << endl;
@@ -168,12 +156,9 @@ Vector &FeatureJointLimits::computeError(Vector &error, int time) {
   assert(SIZE <= SIZE_TOTAL);
 
   error.resize(SIZE);
-
-  unsigned int parcerr = 0;
-  for (int i = 0; i < SIZE_TOTAL; ++i) {
-    if (fl(i)) {
-      error(parcerr++) = (q(i) - LJL(i)) / WJL(i) * 2 - 1;
-    }
+  for (Vector::Index k = 0; k < SIZE; ++k) {
+    const Vector::Index i = selected[k];
+    error(k) = (q(i) - LJL(i)) / WJL(i) * 2 - 1;
   }
 
   sotDEBUGOUT(15);
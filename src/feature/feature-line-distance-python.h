@@ -1,3 +1,5 @@
 #include <sot/core/feature-line-distance.hh>
 
-typedef boost::mpl::vector<dynamicgraph::sot::FeatureLineDistance> entities_t;
+typedef boost::mpl::vector<dynamicgraph::sot::FeatureLineDistance,
+                           dynamicgraph::sot::FeatureLineDistances>
+    entities_t;
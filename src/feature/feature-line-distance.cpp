@@ -25,6 +25,8 @@ using namespace dynamicgraph;
 
 #include <sot/core/factory.hh>
 DYNAMICGRAPH_FACTORY_ENTITY_PLUGIN(FeatureLineDistance, "FeatureLineDistance");
+DYNAMICGRAPH_FACTORY_ENTITY_PLUGIN(FeatureLineDistances,
+                                   "FeatureLineDistances");
 
 /* --------------------------------------------------------------------- */
 /* --- CLASS ----------------------------------------------------------- */
@@ -89,6 +91,26 @@ Vector &FeatureLineDistance::computeLineCoordinates(Vector &cood, int time) {
   return cood;
 }
 
+/* --------------------------------------------------------------------- */
+double FeatureLineDistance::computeDistance(const Eigen::Vector3d &p0,
+                                           const Eigen::Vector3d &u0,
+                                           const Eigen::Vector3d &p1,
+                                           const Eigen::Vector3d &u1,
+                                           Eigen::Vector3d *dp0,
+                                           Eigen::Vector3d *du0) {
+  /* With d = p1 - p0, n = u0 x u1 and K = |n|^2, e = d.n / K. */
+  const Eigen::Vector3d d = p1 - p0;
+  const Eigen::Vector3d n = u0.cross(u1);
+  const double K = n.squaredNorm();
+  const double e = d.dot(n) / K;
+
+  if (dp0 != NULL)
+    *dp0 = -n / K;
+  if (du0 != NULL)
+    *du0 = (u1.cross(d) - 2 * e * u1.cross(n)) / K;
+  return e;
+}
+
 /* --------------------------------------------------------------------- */
 /** Compute the interaction matrix from a subset of
  * the possible features.
@@ -96,142 +118,22 @@ Vector &FeatureLineDistance::computeLineCoordinates(Vector &cood, int time) {
 Matrix &FeatureLineDistance::computeJacobian(Matrix &J, int time) {
   sotDEBUG(15) << "# In {" << endl;
 
-  /* --- Compute the jacobian of the line coordinates --- */
-  Matrix Jline;
-  {
-    const Matrix &Jq = articularJacobianSIN(time);
-
-    const Vector &vect = vectorSIN(time);
-    const MatrixHomogeneous &M = positionSIN(time);
-    MatrixRotation R;
-    R = M.linear(); // wRh
-
-    Matrix Skew(3, 3);
-    Skew(0, 0) = 0;
-    Skew(0, 1) = -vect(2);
-    Skew(0, 2) = vect(1);
-    Skew(1, 0) = vect(2);
-    Skew(1, 1) = 0;
-    Skew(1, 2) = -vect(0);
-    Skew(2, 0) = -vect(1);
-    Skew(2, 1) = vect(0);
-    Skew(2, 2) = 0;
-
-    Matrix RSk(3, 3);
-    RSk = R * Skew;
-
-    Jline.resize(6, Jq.cols());
-    for (unsigned int i = 0; i < 3; ++i)
-      for (int j = 0; j < Jq.cols(); ++j) {
-        Jline(i, j) = 0;
-        Jline(i + 3, j) = 0;
-        for (unsigned int k = 0; k < 3; ++k) {
-          Jline(i, j) += R(i, k) * Jq(k, j);
-          Jline(i + 3, j) += -RSk(i, k) * Jq(k + 3, j);
-        }
-      }
-  }
-
-  /* --- Compute the jacobian wrt the line coordinates --- */
+  const Matrix &Jq = articularJacobianSIN(time);
+  const Eigen::Vector3d vect(vectorSIN(time));
+  const MatrixRotation R(positionSIN(time).linear()); // wRh
   const Vector &line = lineSOUT(time);
-  const double &x0 = line(0);
-  const double &y0 = line(1);
-  const double &z0 = line(2);
-  const double &a0 = line(3);
-  const double &b0 = line(4);
-  const double &c0 = line(5);
-
   const Vector &posRef = positionRefSIN(time);
-  const double &x1 = posRef(0);
-  const double &y1 = posRef(1);
-  const double &z1 = posRef(2);
-  const double &a1 = posRef(3);
-  const double &b1 = posRef(4);
-  const double &c1 = posRef(5);
-
-  /* Differential */
-  const double a1_3 = a1 * a1 * a1;
-  const double b1_3 = b1 * b1 * b1;
-  const double c1_3 = c1 * c1 * c1;
-
-  double K = c0 * c0 * a1 * a1 - 2 * c0 * a1 * a0 * c1 - 2 * c0 * b1 * b0 * c1 +
-             c0 * c0 * b1 * b1 - 2 * b0 * a1 * a0 * b1 + b0 * b0 * a1 * a1 +
-             b0 * b0 * c1 * c1 + a0 * a0 * b1 * b1 + a0 * a0 * c1 * c1;
-
-  const double diffx0 = -b0 * c1 + c0 * b1;
-  const double diffy0 = a0 * c1 - c0 * a1;
-  const double diffz0 = -a0 * b1 + b0 * a1;
-
-  const double diffa0 =
-      2 * b0 * c1 * x0 * a0 * b1 * b1 + 2 * c0 * b1 * b1 * x0 * b0 * a1 +
-      2 * c0 * c0 * b1 * x0 * c1 * a1 + 2 * c1 * c1 * y0 * c0 * a1 * a0 -
-      2 * b0 * c1 * c1 * x0 * c0 * a1 - 2 * b0 * b0 * c1 * x0 * b1 * a1 -
-      2 * c1 * c1 * y0 * c0 * b1 * b0 + 2 * b0 * b0 * c1 * x1 * b1 * a1 +
-      2 * b0 * c1 * c1 * x1 * c0 * a1 - 2 * b0 * c1 * x1 * a0 * b1 * b1 -
-      c1 * y0 * c0 * c0 * a1 * a1 + c1 * y0 * c0 * c0 * b1 * b1 +
-      c1 * y0 * b0 * b0 * a1 * a1 - c1 * y0 * a0 * a0 * b1 * b1 +
-      c1 * y1 * c0 * c0 * a1 * a1 - c1 * y1 * c0 * c0 * b1 * b1 -
-      c1 * y1 * b0 * b0 * a1 * a1 + c1 * y1 * a0 * a0 * b1 * b1 -
-      b1 * z0 * c0 * c0 * a1 * a1 + b1 * z0 * b0 * b0 * a1 * a1 -
-      b1 * z0 * b0 * b0 * c1 * c1 + b1 * z0 * a0 * a0 * c1 * c1 +
-      b1 * z1 * c0 * c0 * a1 * a1 - b1 * z1 * b0 * b0 * a1 * a1 +
-      b1 * z1 * b0 * b0 * c1 * c1 - b1 * z1 * a0 * a0 * c1 * c1 +
-      2 * b0 * c1_3 * x0 * a0 - 2 * b0 * c1_3 * x1 * a0 -
-      2 * c0 * b1_3 * x0 * a0 + 2 * c0 * b1_3 * x1 * a0 + c1_3 * y0 * b0 * b0 -
-      c1_3 * y0 * a0 * a0 - c1_3 * y1 * b0 * b0 + c1_3 * y1 * a0 * a0 -
-      b1_3 * z0 * c0 * c0 + b1_3 * z0 * a0 * a0 + b1_3 * z1 * c0 * c0 -
-      b1_3 * z1 * a0 * a0 - 2 * c1 * c1 * y1 * c0 * a1 * a0 +
-      2 * c1 * c1 * y1 * c0 * b1 * b0 + 2 * b1 * b1 * z0 * c0 * b0 * c1 -
-      2 * b1 * b1 * z0 * b0 * a1 * a0 - 2 * b1 * b1 * z1 * c0 * b0 * c1 +
-      2 * b1 * b1 * z1 * b0 * a1 * a0 - 2 * c0 * b1 * x0 * a0 * c1 * c1 -
-      2 * c0 * b1 * b1 * x1 * b0 * a1 - 2 * c0 * c0 * b1 * x1 * c1 * a1 +
-      2 * c0 * b1 * x1 * a0 * c1 * c1 + 2 * c0 * a1 * y0 * a0 * b1 * b1 -
-      2 * c0 * a1 * a1 * y0 * b1 * b0 - 2 * c0 * a1 * y1 * a0 * b1 * b1 +
-      2 * c0 * a1 * a1 * y1 * b1 * b0 + 2 * b0 * a1 * a1 * z0 * c1 * c0 -
-      2 * b0 * a1 * z0 * a0 * c1 * c1 - 2 * b0 * a1 * a1 * z1 * c1 * c0 +
-      2 * b0 * a1 * z1 * a0 * c1 * c1;
-  const double diffb0 =
-      -2 * c1 * c1 * x0 * c0 * b1 * b0 + 2 * c1 * c1 * x0 * c0 * a1 * a0 -
-      c1 * x0 * c0 * c0 * a1 * a1 + c1 * x0 * c0 * c0 * b1 * b1 +
-      c1 * x0 * b0 * b0 * a1 * a1 - c1 * x0 * a0 * a0 * b1 * b1 +
-      c1 * x1 * c0 * c0 * a1 * a1 - c1 * x1 * c0 * c0 * b1 * b1 -
-      c1 * x1 * b0 * b0 * a1 * a1 + c1 * x1 * a0 * a0 * b1 * b1 +
-      a1 * z0 * c0 * c0 * b1 * b1 - a1 * z0 * b0 * b0 * c1 * c1 -
-      a1 * z0 * a0 * a0 * b1 * b1 + a1 * z0 * a0 * a0 * c1 * c1 -
-      a1 * z1 * c0 * c0 * b1 * b1 + a1 * z1 * b0 * b0 * c1 * c1 +
-      a1 * z1 * a0 * a0 * b1 * b1 - a1 * z1 * a0 * a0 * c1 * c1 -
-      2 * a0 * c1_3 * y0 * b0 + 2 * a0 * c1_3 * y1 * b0 + c1_3 * x0 * b0 * b0 -
-      c1_3 * x0 * a0 * a0 - c1_3 * x1 * b0 * b0 + c1_3 * x1 * a0 * a0 +
-      a1_3 * z0 * c0 * c0 - 2 * c1 * c1 * x1 * c0 * a1 * a0 +
-      2 * c1 * c1 * x1 * c0 * b1 * b0 - 2 * a1 * a1 * z0 * c0 * a0 * c1 +
-      2 * a1 * a1 * z0 * b0 * a0 * b1 - a1_3 * z0 * b0 * b0 -
-      a1_3 * z1 * c0 * c0 + a1_3 * z1 * b0 * b0 +
-      2 * a1 * a1 * z1 * c0 * a0 * c1 - 2 * a1 * a1 * z1 * b0 * a0 * b1 +
-      2 * c0 * b1 * b1 * x0 * a1 * a0 - 2 * c0 * b1 * x0 * b0 * a1 * a1 -
-      2 * c0 * b1 * b1 * x1 * a1 * a0 + 2 * c0 * b1 * x1 * b0 * a1 * a1 +
-      2 * a0 * a0 * c1 * y0 * a1 * b1 - 2 * a0 * c1 * y0 * b0 * a1 * a1 +
-      2 * a0 * c1 * c1 * y0 * c0 * b1 - 2 * a0 * a0 * c1 * y1 * a1 * b1 +
-      2 * a0 * c1 * y1 * b0 * a1 * a1 - 2 * a0 * c1 * c1 * y1 * c0 * b1 -
-      2 * c0 * a1 * a1 * y0 * a0 * b1 + 2 * c0 * a1_3 * y0 * b0 -
-      2 * c0 * a1_3 * y1 * b0 + 2 * c0 * a1 * y0 * b0 * c1 * c1 -
-      2 * c0 * c0 * a1 * y0 * c1 * b1 + 2 * c0 * a1 * a1 * y1 * a0 * b1 -
-      2 * c0 * a1 * y1 * b0 * c1 * c1 + 2 * c0 * c0 * a1 * y1 * c1 * b1 +
-      2 * a0 * b1 * z0 * b0 * c1 * c1 - 2 * a0 * b1 * b1 * z0 * c1 * c0 -
-      2 * a0 * b1 * z1 * b0 * c1 * c1 + 2 * a0 * b1 * b1 * z1 * c1 * c0;
-
-  Matrix diffh(1, 6);
-  diffh(0, 0) = diffx0 / K;
-  diffh(0, 1) = diffy0 / K;
-  diffh(0, 2) = diffz0 / K;
-  K *= K;
-  diffh(0, 3) = diffa0 / K;
-  diffh(0, 4) = diffb0 / K;
-  diffh(0, 5) = 0;
-
-  /* --- Multiply Jline=dline/dq with diffh=de/dline --- */
-  J.resize(1, J.cols());
-  J = diffh * Jline;
-  // J=Jline;
+
+  /* --- Differential of the error wrt the line coordinates --- */
+  Eigen::Vector3d dp0, du0;
+  computeDistance(line.head<3>(), line.tail<3>(), posRef.head<3>(),
+                  posRef.tail<3>(), &dp0, &du0);
+
+  /* --- Multiply by dline/dq = [ R Jt ; -R [vect]x Jr ] --- */
+  Vector6d diffh;
+  diffh.head<3>() = R.transpose() * dp0;
+  diffh.tail<3>() = vect.cross(R.transpose() * du0);
+  J.noalias() = diffh.transpose() * Jq;
 
   sotDEBUG(15) << "# Out }" << endl;
   return J;
@@ -245,33 +147,11 @@ Vector &FeatureLineDistance::computeError(Vector &error, int time) {
 
   /* Line coordinates */
   const Vector &line = lineSOUT(time);
-  const double &x0 = line(0);
-  const double &y0 = line(1);
-  const double &z0 = line(2);
-  const double &a0 = line(3);
-  const double &b0 = line(4);
-  const double &c0 = line(5);
-
   const Vector &posRef = positionRefSIN(time);
-  const double &x1 = posRef(0);
-  const double &y1 = posRef(1);
-  const double &z1 = posRef(2);
-  const double &a1 = posRef(3);
-  const double &b1 = posRef(4);
-  const double &c1 = posRef(5);
 
   error.resize(1);
-  double K = c0 * c0 * a1 * a1 - 2 * c0 * a1 * a0 * c1 - 2 * c0 * b1 * b0 * c1 +
-             c0 * c0 * b1 * b1 - 2 * b0 * a1 * a0 * b1 + b0 * b0 * a1 * a1 +
-             b0 * b0 * c1 * c1 + a0 * a0 * b1 * b1 + a0 * a0 * c1 * c1;
-  error(0) = (-b0 * c1 * x0 + b0 * c1 * x1 + c0 * b1 * x0 - c0 * b1 * x1 +
-              a0 * c1 * y0 - a0 * c1 * y1 - c0 * a1 * y0 + c0 * a1 * y1 -
-              a0 * b1 * z0 + a0 * b1 * z1 + b0 * a1 * z0 - b0 * a1 * z1) /
-             K;
-
-  /* --- DEBUG --- */
-  //   error.resize(6);
-  //   error=line-posRef;
+  error(0) = computeDistance(line.head<3>(), line.tail<3>(), posRef.head<3>(),
+                             posRef.tail<3>());
 
   sotDEBUGOUT(15);
   return error;
@@ -280,3 +160,130 @@ Vector &FeatureLineDistance::computeError(Vector &error, int time) {
 void FeatureLineDistance::display(std::ostream &os) const {
   os << "LineDistance <" << name << ">";
 }
+
+/* --------------------------------------------------------------------- */
+/* --- LINES ----------------------------------------------------------- */
+/* --------------------------------------------------------------------- */
+
+FeatureLineDistances::FeatureLineDistances(const string &pointName)
+    : FeatureAbstract(pointName),
+      positionSIN(NULL, "sotFeatureLineDistances(" + name +
+                            ")::input(matrixHomo)::position"),
+      articularJacobianSIN(NULL, "sotFeatureLineDistances(" + name +
+                                     ")::input(matrix)::Jq"),
+      positionRefSIN(NULL, "sotFeatureLineDistances(" + name +
+                               ")::input(vector)::positionRef"),
+      vectorSIN(NULL,
+                "sotFeatureLineDistances(" + name + ")::input(vector)::vector"),
+      lineSOUT(boost::bind(&FeatureLineDistances::computeLineCoordinates, this,
+                           _1, _2),
+               positionSIN << vectorSIN,
+               "sotFeatureLineDistances(" + name + ")::output(vector)::line") {
+  jacobianSOUT.addDependency(lineSOUT);
+  jacobianSOUT.addDependency(positionRefSIN);
+  jacobianSOUT.addDependency(articularJacobianSIN);
+
+  errorSOUT.addDependency(lineSOUT);
+  errorSOUT.addDependency(positionRefSIN);
+
+  dimensionSOUT.addDependency(vectorSIN);
+
+  signalRegistration(positionSIN << articularJacobianSIN << positionRefSIN
+                                 << lineSOUT << vectorSIN);
+}
+
+unsigned int &FeatureLineDistances::getDimension(unsigned int &dim, int time) {
+  const Flags &fl = selectionSIN.access(time);
+  dim = static_cast<unsigned int>(fl.count(vectorSIN.access(time).size() / 3));
+  return dim;
+}
+
+Vector &FeatureLineDistances::computeLineCoordinates(Vector &cood, int time) {
+  sotDEBUGIN(15);
+
+  const MatrixHomogeneous &pos = positionSIN(time);
+  const Vector &vect = vectorSIN(time);
+  const Eigen::Index N = vect.size() / 3;
+  if (vect.size() != 3 * N) {
+    throw(ExceptionFeature(ExceptionFeature::UNCOMPATIBLE_SIZE,
+                           "Size of vector should be a multiple of 3",
+                           " (%d).", (int)vect.size()));
+  }
+
+  /* One column (point, direction) per line. */
+  cood.resize(6 * N);
+  Eigen::Map<Eigen::Matrix<double, 6, Eigen::Dynamic> > lines(cood.data(), 6,
+                                                               N);
+  lines.topRows<3>().colwise() = pos.translation();
+  lines.bottomRows<3>().noalias() =
+      pos.linear() * Eigen::Map<const Eigen::Matrix3Xd>(vect.data(), 3, N);
+
+  sotDEBUGOUT(15);
+  return cood;
+}
+
+Matrix &FeatureLineDistances::computeJacobian(Matrix &J, int time) {
+  sotDEBUG(15) << "# In {" << endl;
+
+  const Vector &line = lineSOUT(time);
+  const Vector &posRef = positionRefSIN(time);
+  const Vector &vect = vectorSIN(time);
+  const Matrix &Jq = articularJacobianSIN(time);
+  const MatrixRotation R(positionSIN(time).linear()); // wRh
+  const Eigen::Index N = line.size() / 6;
+  if (posRef.size() != 6 * N) {
+    throw(ExceptionFeature(ExceptionFeature::UNCOMPATIBLE_SIZE,
+                           "Size of positionRef should be 6 times the number "
+                           "of lines",
+                           " (%d != 6*%d).", (int)posRef.size(), (int)N));
+  }
+
+  /* Row k of J is diffh(k) Jq, with diffh(k) the differential of the error
+   * of the k-th selected line wrt the body velocity. */
+  const Flags::Indices_t &selected = selectionSIN(time).selectedIndices(N);
+  diffh.resize(static_cast<Eigen::Index>(selected.size()), 6);
+  Eigen::Vector3d dp0, du0;
+  for (std::size_t k = 0; k < selected.size(); ++k) {
+    const Eigen::Index i = selected[k];
+    FeatureLineDistance::computeDistance(
+        line.segment<3>(6 * i), line.segment<3>(6 * i + 3),
+        posRef.segment<3>(6 * i), posRef.segment<3>(6 * i + 3), &dp0, &du0);
+    const Eigen::Vector3d v(vect.segment<3>(3 * i));
+    diffh.row(k).head<3>() = R.transpose() * dp0;
+    diffh.row(k).tail<3>() = v.cross(R.transpose() * du0);
+  }
+  J.noalias() = diffh * Jq;
+
+  sotDEBUG(15) << "# Out }" << endl;
+  return J;
+}
+
+Vector &FeatureLineDistances::computeError(Vector &error, int time) {
+  sotDEBUGIN(15);
+
+  const Vector &line = lineSOUT(time);
+  const Vector &posRef = positionRefSIN(time);
+  const Eigen::Index N = line.size() / 6;
+  if (posRef.size() != 6 * N) {
+    throw(ExceptionFeature(ExceptionFeature::UNCOMPATIBLE_SIZE,
+                           "Size of positionRef should be 6 times the number "
+                           "of lines",
+                           " (%d != 6*%d).", (int)posRef.size(), (int)N));
+  }
+
+  const Flags::Indices_t &selected = selectionSIN(time).selectedIndices(N);
+  error.resize(static_cast<Eigen::Index>(selected.size()));
+  for (std::size_t k = 0; k < selected.size(); ++k) {
+    const Eigen::Index i = selected[k];
+    error(k) = FeatureLineDistance::computeDistance(
+        line.segment<3>(6 * i), line.segment<3>(6 * i + 3),
+        posRef.segment<3>(6 * i), posRef.segment<3>(6 * i + 3));
+  }
+
+  sotDEBUGOUT(15);
+  return error;
+}
+
+void FeatureLineDistances::display(std::ostream &os) const {
+  os << "LineDistances <" << name << ">";
+}
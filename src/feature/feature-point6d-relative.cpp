@@ -75,32 +75,24 @@ Matrix &FeaturePoint6dRelative::computeJacobian(Matrix &Jres, int time) {
   const MatrixHomogeneous &wMp = positionSIN(time);
   const MatrixHomogeneous &wMpref = positionReferenceSIN(time);
 
-  const Matrix::Index cJ = Jq.cols();
-  Matrix J(6, cJ);
-  {
-    MatrixHomogeneous pMw;
-    pMw = wMp.inverse(Eigen::Affine);
-    MatrixHomogeneous pMpref;
-    pMpref = pMw * wMpref;
-
-    MatrixTwist pVpref;
-    buildFrom(pMpref, pVpref);
-    J = pVpref * JqRef;
-    J -= Jq;
-  }
+  MatrixHomogeneous pMpref;
+  pMpref = wMp.inverse(Eigen::Isometry) * wMpref;
+  MatrixTwist pVpref;
+  buildFrom(pMpref, pVpref);
 
+  /* J = pVpref * JqRef - Jq, restricted to the selected rows. */
   const Flags &fl = selectionSIN(time);
   const int dim = dimensionSOUT(time);
   sotDEBUG(15) << "Dimension=" << dim << std::endl;
-  Jres.resize(dim, cJ);
-
-  unsigned int rJ = 0;
-  for (unsigned int r = 0; r < 6; ++r)
-    if (fl(r)) {
-      for (unsigned int c = 0; c < cJ; ++c)
-        Jres(rJ, c) = J(r, c);
-      rJ++;
-    }
+
+  Eigen::Matrix<double, Eigen::Dynamic, 6, Eigen::RowMajor, 6, 6> pVprefSel;
+  fl.gatherRows(pVpref, pVprefSel);
+  Jres.resize(dim, Jq.cols());
+  Jres.noalias() = pVprefSel * JqRef;
+
+  const Flags::Indices_t &selected = fl.selectedIndices(6);
+  for (std::size_t k = 0; k < selected.size(); ++k)
+    Jres.row(static_cast<Eigen::Index>(k)) -= Jq.row(selected[k]);
 
   sotDEBUG(15) << "# Out }" << endl;
   return Jres;
@@ -118,10 +110,8 @@ Vector &FeaturePoint6dRelative::computeError(Vector &error, int time) {
   const MatrixHomogeneous &wMp = positionSIN(time);
   const MatrixHomogeneous &wMpref = positionReferenceSIN(time);
 
-  MatrixHomogeneous pMw;
-  pMw = wMp.inverse(Eigen::Affine);
   MatrixHomogeneous pMpref;
-  pMpref = pMw * wMpref;
+  pMpref = wMp.inverse(Eigen::Isometry) * wMpref;
 
   MatrixHomogeneous Merr;
   try {
@@ -134,17 +124,15 @@ Vector &FeaturePoint6dRelative::computeError(Vector &error, int time) {
         const MatrixHomogeneous &wMp_des = sdes6d->positionSIN(time);
         const MatrixHomogeneous &wMpref_des =
             sdes6d->positionReferenceSIN(time);
-        MatrixHomogeneous pMw_des;
-        pMw_des = wMp_des.inverse(Eigen::Affine);
         MatrixHomogeneous pMpref_des;
-        pMpref_des = pMw_des * wMpref_des;
+        pMpref_des = wMp_des.inverse(Eigen::Isometry) * wMpref_des;
         MatrixHomogeneous Minv;
-        Minv = pMpref_des.inverse(Eigen::Affine);
+        Minv = pMpref_des.inverse(Eigen::Isometry);
         Merr = pMpref * Minv;
       } else {
         const MatrixHomogeneous &Mref = getReference()->positionSIN(time);
         MatrixHomogeneous Minv;
-        Minv = Mref.inverse(Eigen::Affine);
+        Minv = Mref.inverse(Eigen::Isometry);
         Merr = pMpref * Minv;
       }
     } else {
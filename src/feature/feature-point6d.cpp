@@ -147,11 +147,7 @@ unsigned int &FeaturePoint6d::getDimension(unsigned int &dim, int time) {
   sotDEBUG(25) << "# In {" << endl;
 
   const Flags &fl = selectionSIN.access(time);
-
-  dim = 0;
-  for (int i = 0; i < 6; ++i)
-    if (fl(i))
-      dim++;
+  dim = static_cast<unsigned int>(fl.count(6));
 
   sotDEBUG(25) << "# Out }" << endl;
   return dim;
@@ -176,94 +172,59 @@ Matrix &FeaturePoint6d::computeJacobian(Matrix &J, int time) {
 
   sotDEBUG(15) << "Dimension=" << dim << std::endl;
 
-  const Matrix::Index cJ = Jq.cols();
-  J.resize(dim, cJ);
-  Matrix LJq(6, cJ);
+  /* J = Lx Jq, where Lx is a 6x6 matrix built below. Only the selected
+   * rows of Lx are kept, so that J is written in one product. */
+  Eigen::Matrix<double, 6, 6> Lx;
+  const MatrixHomogeneous &wMh = positionSIN(time);
+  const MatrixRotation wRh(wMh.linear());
 
   if (FRAME_CURRENT == computationFrame_) {
     /* The Jacobian on rotation is equal to Jr = - hdRh Jr6d.
      * The Jacobian in translation is equalt to Jt = [hRw(wthd-wth)]x Jr - Jt.
      */
-    const MatrixHomogeneous &wMh = positionSIN(time);
-    MatrixRotation wRh;
-    wRh = wMh.linear();
     MatrixRotation wRhd;
-    Vector hdth(3), Rhdth(3);
+    Eigen::Vector3d hdth;
 
     if (isReferenceSet()) {
       const MatrixHomogeneous &wMhd = getReference()->positionSIN(time);
       wRhd = wMhd.linear();
-      for (unsigned int i = 0; i < 3; ++i)
-        hdth(i) = wMhd(i, 3) - wMh(i, 3);
+      hdth = wMhd.translation() - wMh.translation();
     } else {
       wRhd.setIdentity();
-      for (unsigned int i = 0; i < 3; ++i)
-        hdth(i) = -wMh(i, 3);
+      hdth = -wMh.translation();
     }
-    Rhdth = (wRh.inverse()) * hdth;
-    MatrixRotation hdRh;
-    hdRh = (wRhd.inverse()) * wRh;
+    const Eigen::Vector3d Rhdth = wRh.transpose() * hdth;
+    const MatrixRotation hdRh = wRhd.transpose() * wRh;
 
-    Matrix Lx(6, 6);
-    for (unsigned int i = 0; i < 3; i++) {
-      for (unsigned int j = 0; j < 3; j++) {
-        if (i == j) {
-          Lx(i, j) = -1;
-        } else {
-          Lx(i, j) = 0;
-        }
-        Lx(i + 3, j) = 0;
-        Lx(i + 3, j + 3) = -hdRh(i, j);
-      }
-    }
     const double &X = Rhdth(0), &Y = Rhdth(1), &Z = Rhdth(2);
-    Lx(0, 4) = -Z;
-    Lx(0, 5) = Y;
-    Lx(1, 3) = Z;
-    Lx(1, 5) = -X;
-    Lx(2, 3) = -Y;
-    Lx(2, 4) = X;
-    Lx(0, 3) = 0;
-    Lx(1, 4) = 0;
-    Lx(2, 5) = 0;
+    Lx.topLeftCorner<3, 3>() = -Eigen::Matrix3d::Identity();
+    Lx.topRightCorner<3, 3>() << 0, -Z, Y, Z, 0, -X, -Y, X, 0;
+    Lx.bottomLeftCorner<3, 3>().setZero();
+    Lx.bottomRightCorner<3, 3>() = -hdRh;
     sotDEBUG(15) << "Lx= " << Lx << endl;
-
-    LJq = Lx * Jq;
   } else {
     /* The Jacobian in rotation is equal to Jr = hdJ = hdRh Jr.
      * The Jacobian in translation is equal to Jr = hdJ = hdRh Jr. */
-    const MatrixHomogeneous &wMh = positionSIN(time);
-    MatrixRotation wRh;
-    wRh = wMh.linear();
     MatrixRotation hdRh;
 
     if (isReferenceSet()) {
       const MatrixHomogeneous &wMhd = getReference()->positionSIN(time);
-      MatrixRotation wRhd;
-      wRhd = wMhd.linear();
-      hdRh = (wRhd.inverse()) * wRh;
+      hdRh = wMhd.linear().transpose() * wRh;
     } else {
       hdRh = wRh;
     }
 
-    LJq.fill(0);
-    for (unsigned int i = 0; i < 3; i++)
-      for (unsigned int j = 0; j < cJ; j++) {
-        for (unsigned int k = 0; k < 3; k++) {
-          LJq(i, j) += hdRh(i, k) * Jq(k, j);
-          LJq(i + 3, j) += hdRh(i, k) * Jq(k + 3, j);
-        }
-      }
+    Lx.topLeftCorner<3, 3>() = hdRh;
+    Lx.topRightCorner<3, 3>().setZero();
+    Lx.bottomLeftCorner<3, 3>().setZero();
+    Lx.bottomRightCorner<3, 3>() = hdRh;
   }
 
   /* Select the active line of Jq. */
-  unsigned int rJ = 0;
-  for (unsigned int r = 0; r < 6; ++r)
-    if (fl(r)) {
-      for (unsigned int c = 0; c < cJ; ++c)
-        J(rJ, c) = LJq(r, c);
-      rJ++;
-    }
+  Eigen::Matrix<double, Eigen::Dynamic, 6, Eigen::RowMajor, 6, 6> LxSel;
+  fl.gatherRows(Lx, LxSel);
+  J.resize(dim, Jq.cols());
+  J.noalias() = LxSel * Jq;
 
   sotDEBUG(15) << "# Out }" << endl;
   return J;
@@ -272,7 +233,7 @@ Matrix &FeaturePoint6d::computeJacobian(Matrix &J, int time) {
 #define SOT_COMPUTE_H1MH2(wMh, wMhd, hMhd)                                     \
   {                                                                            \
     MatrixHomogeneous hMw;                                                     \
-    hMw = wMh.inverse(Eigen::Affine);                                          \
+    hMw = wMh.inverse(Eigen::Isometry);                                        \
     sotDEBUG(15) << "hMw = " << hMw << endl;                                   \
     hMhd = hMw * wMhd;                                                         \
     sotDEBUG(15) << "hMhd = " << hMhd << endl;                                 \
@@ -309,7 +270,7 @@ Vector &FeaturePoint6d::computeError(Vector &error, int time) {
   } else {
     switch (computationFrame_) {
     case FRAME_CURRENT:
-      hMhd = wMh.inverse();
+      hMhd = wMh.inverse(Eigen::Isometry);
       break;
     case FRAME_DESIRED:
       hMhd = wMh;
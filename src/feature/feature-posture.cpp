@@ -39,7 +39,7 @@ FeaturePosture::FeaturePosture(const std::string &name)
       state_(NULL, "FeaturePosture(" + name + ")::input(Vector)::state"),
       posture_(0, "FeaturePosture(" + name + ")::input(Vector)::posture"),
       postureDot_(0, "FeaturePosture(" + name + ")::input(Vector)::postureDot"),
-      activeDofs_(), nbActiveDofs_(0) {
+      activeDofs_(), nbActiveDofs_(0), activeDofIndices_() {
   signalRegistration(state_ << posture_ << postureDot_);
 
   errorSOUT.addDependency(state_);
@@ -73,12 +73,9 @@ dg::Vector &FeaturePosture::computeError(dg::Vector &res, int t) {
   const dg::Vector &posture = posture_.access(t);
 
   res.resize(nbActiveDofs_);
-  std::size_t index = 0;
-  for (std::size_t i = 0; i < activeDofs_.size(); ++i) {
-    if (activeDofs_[i]) {
-      res(index) = state(i) - posture(i);
-      index++;
-    }
+  for (std::size_t k = 0; k < activeDofIndices_.size(); ++k) {
+    const Eigen::Index i = activeDofIndices_[k];
+    res(k) = state(i) - posture(i);
   }
   return res;
 }
@@ -92,11 +89,8 @@ dg::Vector &FeaturePosture::computeErrorDot(dg::Vector &res, int t) {
   const Vector &postureDot = postureDot_.access(t);
 
   res.resize(nbActiveDofs_);
-  std::size_t index = 0;
-  for (std::size_t i = 0; i < activeDofs_.size(); ++i) {
-    if (activeDofs_[i])
-      res(index++) = -postureDot(i);
-  }
+  for (std::size_t k = 0; k < activeDofIndices_.size(); ++k)
+    res(k) = -postureDot(activeDofIndices_[k]);
   return res;
 }
 
@@ -135,17 +129,17 @@ void FeaturePosture::selectDof(unsigned dofId, bool control) {
     }
   }
   // recompute jacobian
-  Matrix J(Matrix::Zero(nbActiveDofs_, dim));
+  activeDofIndices_.clear();
+  for (std::size_t i = 0; i < activeDofs_.size(); ++i)
+    if (activeDofs_[i])
+      activeDofIndices_.push_back(static_cast<Eigen::Index>(i));
 
-  std::size_t index = 0;
-  for (std::size_t i = 0; i < activeDofs_.size(); ++i) {
-    if (activeDofs_[i]) {
-      J(index, i) = 1;
-      index++;
-    }
-  }
+  Matrix J(Matrix::Zero(nbActiveDofs_, dim));
+  for (std::size_t k = 0; k < activeDofIndices_.size(); ++k)
+    J(k, activeDofIndices_[k]) = 1;
 
   jacobianSOUT.setConstant(J);
+  topologyChanged();
 }
 
 DYNAMICGRAPH_FACTORY_ENTITY_PLUGIN(FeaturePosture, "FeaturePosture");
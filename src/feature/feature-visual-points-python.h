@@ -0,0 +1,3 @@
+#include <sot/core/feature-visual-points.hh>
+
+typedef boost::mpl::vector<dynamicgraph::sot::FeatureVisualPoints> entities_t;
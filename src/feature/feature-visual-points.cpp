@@ -0,0 +1,183 @@
+/*
+ * Copyright 2020,
+ * CNRS/AIST
+ *
+ */
+
+/* --------------------------------------------------------------------- */
+/* --- INCLUDE --------------------------------------------------------- */
+/* --------------------------------------------------------------------- */
+
+/* --- SOT --- */
+#include <sot/core/debug.hh>
+#include <sot/core/exception-feature.hh>
+#include <sot/core/factory.hh>
+#include <sot/core/feature-visual-points.hh>
+using namespace std;
+using namespace dynamicgraph::sot;
+using namespace dynamicgraph;
+
+DYNAMICGRAPH_FACTORY_ENTITY_PLUGIN(FeatureVisualPoints, "FeatureVisualPoints");
+
+/* --------------------------------------------------------------------- */
+/* --- CLASS ----------------------------------------------------------- */
+/* --------------------------------------------------------------------- */
+
+FeatureVisualPoints::FeatureVisualPoints(const string &pointName)
+    : FeatureAbstract(pointName), L(), Lselected(), xCoordinates(),
+      yCoordinates(), inverseDepth(),
+      xySIN(NULL, "sotFeatureVisualPoints(" + name + ")::input(vector)::xy"),
+      ZSIN(NULL, "sotFeatureVisualPoints(" + name + ")::input(vector)::Z"),
+      articularJacobianSIN(NULL, "sotFeatureVisualPoints(" + name +
+                                     ")::input(matrix)::Jq") {
+  jacobianSOUT.addDependency(xySIN);
+  jacobianSOUT.addDependency(ZSIN);
+  jacobianSOUT.addDependency(articularJacobianSIN);
+
+  errorSOUT.addDependency(xySIN);
+
+  dimensionSOUT.addDependency(xySIN);
+
+  signalRegistration(xySIN << ZSIN << articularJacobianSIN);
+}
+
+void FeatureVisualPoints::addDependenciesFromReference(void) {
+  assert(isReferenceSet());
+  errorSOUT.addDependency(getReference()->xySIN);
+}
+
+void FeatureVisualPoints::removeDependenciesFromReference(void) {
+  assert(isReferenceSet());
+  errorSOUT.removeDependency(getReference()->xySIN);
+}
+
+/* --------------------------------------------------------------------- */
+/* --------------------------------------------------------------------- */
+/* --------------------------------------------------------------------- */
+
+namespace {
+/// View on the rows of a stacked (x, y) vector or matrix column that
+/// correspond to the x (offset 0) or y (offset 1) coordinates.
+typedef Eigen::Map<Vector, 0, Eigen::InnerStride<2> > Coordinates_t;
+typedef Eigen::Map<const Vector, 0, Eigen::InnerStride<2> >
+    ConstCoordinates_t;
+
+inline Coordinates_t coordinates(Matrix &L, const Matrix::Index col,
+                                 const Matrix::Index offset) {
+  return Coordinates_t(L.col(col).data() + offset, L.rows() / 2);
+}
+} // namespace
+
+unsigned int &FeatureVisualPoints::getDimension(unsigned int &dim, int time) {
+  sotDEBUG(25) << "# In {" << endl;
+
+  const Flags &fl = selectionSIN.access(time);
+  dim = static_cast<unsigned int>(fl.count(xySIN.access(time).size()));
+
+  sotDEBUG(25) << "# Out }" << endl;
+  return dim;
+}
+
+/** Compute the interaction matrix of the selected coordinates of all the
+ * points.
+ */
+Matrix &FeatureVisualPoints::computeJacobian(Matrix &J, int time) {
+  sotDEBUG(15) << "# In {" << endl;
+
+  const Flags &fl = selectionSIN(time);
+  const Vector &xy = xySIN(time);
+  const Vector &Z = ZSIN(time);
+  const Matrix::Index N = Z.size();
+
+  if (xy.size() != 2 * N) {
+    throw(ExceptionFeature(ExceptionFeature::UNCOMPATIBLE_SIZE,
+                           "Sizes of xy and Z do not match", " (%d != 2*%d).",
+                           (int)xy.size(), (int)N));
+  }
+  if ((Z.array() < 0).any()) {
+    throw(ExceptionFeature(ExceptionFeature::BAD_INIT,
+                           "A VisualPoint is behind the camera"));
+  }
+  if ((Z.array().abs() < 1e-6).any()) {
+    throw(ExceptionFeature(ExceptionFeature::BAD_INIT,
+                           "A VisualPoint Z coordinates is null"));
+  }
+
+  xCoordinates = ConstCoordinates_t(xy.data(), N).array();
+  yCoordinates = ConstCoordinates_t(xy.data() + 1, N).array();
+  inverseDepth = Z.array().inverse();
+  const Eigen::ArrayXd &x = xCoordinates, &y = yCoordinates,
+                      &invZ = inverseDepth;
+
+  /* Rows 2i and 2i+1 are the interaction matrix of point i:
+   * [ -1/Z    0  x/Z     x*y  -(1+x*x)   y ]
+   * [    0 -1/Z  y/Z  1+y*y       -x*y  -x ] */
+  L.resize(2 * N, 6);
+  coordinates(L, 0, 0).array() = -invZ;
+  coordinates(L, 0, 1).setZero();
+  coordinates(L, 1, 0).setZero();
+  coordinates(L, 1, 1).array() = -invZ;
+  coordinates(L, 2, 0).array() = x * invZ;
+  coordinates(L, 2, 1).array() = y * invZ;
+  coordinates(L, 3, 0).array() = x * y;
+  coordinates(L, 3, 1).array() = 1 + y * y;
+  coordinates(L, 4, 0).array() = -(1 + x * x);
+  coordinates(L, 4, 1).array() = -x * y;
+  coordinates(L, 5, 0).array() = y;
+  coordinates(L, 5, 1).array() = -x;
+  sotDEBUG(15) << "L:" << endl << L << endl;
+
+  const Matrix &Jq = articularJacobianSIN(time);
+  sotDEBUG(15) << "Jq:" << endl << Jq << endl;
+
+  if (fl.count(2 * N) == 2 * N) {
+    J.noalias() = L * Jq;
+  } else {
+    fl.gatherRows(L, Lselected);
+    J.noalias() = Lselected * Jq;
+  }
+
+  sotDEBUG(15) << "# Out }" << endl;
+  return J;
+}
+
+/** Compute the error between the selected coordinates of the points and
+ * those of the reference.
+ */
+Vector &FeatureVisualPoints::computeError(Vector &error, int time) {
+  sotDEBUGIN(15);
+
+  if (!isReferenceSet()) {
+    throw(ExceptionFeature(ExceptionFeature::BAD_INIT,
+                           "S* is not of adequate type."));
+  }
+
+  const Vector &xy = xySIN(time);
+  const Vector &xyDes = getReference()->xySIN(time);
+  if (xy.size() != xyDes.size()) {
+    throw(ExceptionFeature(ExceptionFeature::UNCOMPATIBLE_SIZE,
+                           "Sizes of xy and of the reference do not match",
+                           " (%d != %d).", (int)xy.size(), (int)xyDes.size()));
+  }
+
+  const Flags::Indices_t &selected =
+      selectionSIN(time).selectedIndices(xy.size());
+  error.resize(static_cast<Vector::Index>(selected.size()));
+  for (std::size_t k = 0; k < selected.size(); ++k)
+    error(static_cast<Vector::Index>(k)) =
+        xy(selected[k]) - xyDes(selected[k]);
+
+  sotDEBUGOUT(15);
+  return error;
+}
+
+void FeatureVisualPoints::display(std::ostream &os) const {
+  os << "VisualPoints <" << name << ">:";
+
+  try {
+    const Vector &xy = xySIN.accessCopy();
+    os << " " << xy.size() / 2 << " points";
+  } catch (const ExceptionAbstract &) {
+    os << " XY not set.";
+  }
+}
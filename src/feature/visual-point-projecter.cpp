@@ -3,8 +3,12 @@
  *
  */
 
+#include <algorithm>
+
+#include <dynamic-graph/all-commands.h>
 #include <dynamic-graph/factory.h>
 #include <sot/core/debug.hh>
+#include <sot/core/exception-feature.hh>
 #include <sot/core/visual-point-projecter.hh>
 
 namespace dynamicgraph {
@@ -32,12 +36,88 @@ VisualPointProjecter::VisualPointProjecter(const std::string &name)
                            m_point3DSIN << m_transfoSIN),
       CONSTRUCT_SIGNAL_OUT(depth, double, m_point3DgazeSOUT),
       CONSTRUCT_SIGNAL_OUT(point2D, dynamicgraph::Vector,
-                           m_point3DgazeSOUT << m_depthSOUT) {
+                           m_point3DgazeSOUT << m_depthSOUT),
+      m_cached(false), m_cacheInitialized(false), m_lastUpdate(0),
+      m_updatePeriod(0), m_extrapolationHorizon(0) {
   Entity::signalRegistration(m_point3DSIN);
   Entity::signalRegistration(m_transfoSIN);
   Entity::signalRegistration(m_point3DgazeSOUT);
   Entity::signalRegistration(m_point2DSOUT);
   Entity::signalRegistration(m_depthSOUT);
+
+  using namespace dynamicgraph::command;
+  addCommand("setCached",
+             makeCommandVoid1(
+                 *this, &VisualPointProjecter::setCached,
+                 docCommandVoid1("Only recompute the projection when the "
+                                 "inputs change, and extrapolate it otherwise.",
+                                 "bool")));
+  addCommand("getCached",
+             makeDirectGetter(*this, &m_cached,
+                              docDirectGetter("cached", "bool")));
+  addCommand("setExtrapolationHorizon",
+             makeCommandVoid1(
+                 *this, &VisualPointProjecter::setExtrapolationHorizon,
+                 docCommandVoid1("Set the maximal number of iterations of "
+                                 "the extrapolation in cached mode, 0 for "
+                                 "the interval between the last two updates.",
+                                 "int")));
+  addCommand("getExtrapolationHorizon",
+             makeDirectGetter(*this, &m_extrapolationHorizon,
+                              docDirectGetter("extrapolation horizon", "int")));
+}
+
+void VisualPointProjecter::setCached(const bool &cached) {
+  m_cached = cached;
+  m_cacheInitialized = false;
+}
+
+void VisualPointProjecter::setExtrapolationHorizon(const int &horizon) {
+  if (horizon < 0)
+    throw ExceptionFeature(ExceptionFeature::GENERIC,
+                           "The extrapolation horizon must not be negative.");
+  m_extrapolationHorizon = horizon;
+}
+
+/* --- CACHE ------------------------------------------------------------ */
+/* --- CACHE ------------------------------------------------------------ */
+/* --- CACHE ------------------------------------------------------------ */
+
+Eigen::Vector3d
+VisualPointProjecter::project(const dynamicgraph::Vector &p3,
+                              const MatrixHomogeneous &M) const {
+  assert(p3.size() == 3);
+  return M.inverse(Eigen::Isometry) * Eigen::Vector3d(p3);
+}
+
+bool VisualPointProjecter::updateCache(int iter) {
+  const dynamicgraph::Vector &p3 = m_point3DSIN(iter);
+  const MatrixHomogeneous &M = m_transfoSIN(iter);
+  if (m_cacheInitialized && p3 == m_point3D &&
+      M.matrix() == m_transfo.matrix())
+    return false;
+
+  const Eigen::Vector3d gaze = project(p3, M);
+  if (!m_cacheInitialized) {
+    m_gazeVelocity.setZero();
+    m_updatePeriod = 0;
+  } else if (iter > m_lastUpdate) {
+    m_updatePeriod = iter - m_lastUpdate;
+    m_gazeVelocity = (gaze - m_gaze) / m_updatePeriod;
+  }
+
+  m_point3D = p3;
+  m_transfo = M;
+  m_gaze = gaze;
+  m_lastUpdate = iter;
+  m_cacheInitialized = true;
+
+  const double z = gaze(2);
+  assert(z > 0);
+  m_point2D = gaze.head<2>() / z;
+  m_projectionJacobian << 1 / z, 0, -m_point2D(0) / z, 0, 1 / z,
+      -m_point2D(1) / z;
+  return true;
 }
 
 /* --- SIGNALS ---------------------------------------------------------- */
@@ -47,11 +127,16 @@ VisualPointProjecter::VisualPointProjecter(const std::string &name)
 dynamicgraph::Vector &
 VisualPointProjecter::point3DgazeSOUT_function(dynamicgraph::Vector &p3g,
                                                int iter) {
-  const dynamicgraph::Vector &p3 = m_point3DSIN(iter);
-  const MatrixHomogeneous &M = m_transfoSIN(iter);
-  MatrixHomogeneous Mi;
-  Mi = M.inverse(Eigen::Affine);
-  p3g = Mi.matrix() * p3;
+  if (m_cached) {
+    updateCache(iter);
+    // Past the horizon, the inputs are assumed to have stopped and the
+    // point is held.
+    const int horizon = m_extrapolationHorizon > 0 ? m_extrapolationHorizon
+                                                   : m_updatePeriod;
+    p3g = m_gaze + m_gazeVelocity * std::min(iter - m_lastUpdate, horizon);
+  } else {
+    p3g = project(m_point3DSIN(iter), m_transfoSIN(iter));
+  }
   return p3g;
 }
 
@@ -63,9 +148,13 @@ VisualPointProjecter::point2DSOUT_function(dynamicgraph::Vector &p2, int iter) {
   const double &z = m_depthSOUT(iter);
   assert(z > 0);
 
-  p2.resize(2);
-  p2(0) = p3(0) / z;
-  p2(1) = p3(1) / z;
+  if (m_cached) {
+    p2 = m_point2D + m_projectionJacobian * (p3 - m_gaze);
+  } else {
+    p2.resize(2);
+    p2(0) = p3(0) / z;
+    p2(1) = p3(1) / z;
+  }
 
   sotDEBUGOUT(15);
   return p2;
@@ -0,0 +1,3 @@
+#include <sot/core/filter-bank.hh>
+
+typedef boost::mpl::vector<dynamicgraph::sot::FilterBank> entities_t;
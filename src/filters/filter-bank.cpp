@@ -0,0 +1,203 @@
+/*
+ * Copyright 2020,
+ * CNRS/AIST
+ *
+ */
+
+#include <boost/function.hpp>
+
+#include <dynamic-graph/all-commands.h>
+#include <dynamic-graph/factory.h>
+
+#include <sot/core/exception-tools.hh>
+#include <sot/core/filter-bank.hh>
+
+namespace dynamicgraph {
+namespace sot {
+
+DYNAMICGRAPH_FACTORY_ENTITY_PLUGIN(FilterBank, "FilterBank");
+
+/* --------------------------------------------------------------------- */
+/* --- CLASS ----------------------------------------------------------- */
+/* --------------------------------------------------------------------- */
+
+FilterBank::FilterBank(const std::string &name)
+    : Entity(name),
+      bankSINTERN(boost::bind(&FilterBank::computeBank, this, _1, _2),
+                  sotNOSIGNAL,
+                  "FilterBank(" + name + ")::intern(dummy)::bank") {
+  using namespace dynamicgraph::command;
+
+  addCommand("addAverage",
+             makeCommandVoid3(
+                 *this, &FilterBank::addAverage,
+                 docCommandVoid3("Add an exponential moving average.",
+                                 "name of the channel (string)",
+                                 "size of the vector (int)",
+                                 "alpha (double)")));
+  addCommand("addDerivative",
+             makeCommandVoid3(
+                 *this, &FilterBank::addDerivative,
+                 docCommandVoid3("Add a finite difference derivative.",
+                                 "name of the channel (string)",
+                                 "size of the vector (int)",
+                                 "timestep (double)")));
+  addCommand("setAlpha",
+             makeCommandVoid2(
+                 *this, &FilterBank::setAlpha,
+                 docCommandVoid2("Set alpha of an average.",
+                                 "name of the channel (string)",
+                                 "alpha (double)")));
+  addCommand("setTimestep",
+             makeCommandVoid2(
+                 *this, &FilterBank::setTimestep,
+                 docCommandVoid2("Set the timestep of a derivative.",
+                                 "name of the channel (string)",
+                                 "timestep (double)")));
+}
+
+FilterBank::~FilterBank() {
+  for (std::size_t i = 0; i < channels.size(); ++i) {
+    Channel &c = channels[i];
+    signalDeregistration(c.sout->shortName());
+    signalDeregistration(c.sin->shortName());
+    bankSINTERN.removeDependency(*c.sin);
+    delete c.sout;
+    delete c.sin;
+  }
+}
+
+std::string FilterBank::getDocString() const {
+  return "Bank of exponential moving averages and derivatives.\n"
+         "\n"
+         "  Command addAverage (name, size, alpha) and addDerivative (name,\n"
+         "  size, timestep) add a channel with input signal sin_name and\n"
+         "  output signal sout_name. All the channels are updated in a\n"
+         "  single pass over contiguous buffers.\n";
+}
+
+/* --- CHANNELS ---------------------------------------------------------- */
+
+FilterBank::Channel &FilterBank::addChannel(const std::string &name,
+                                            const int &size,
+                                            const bool isDerivative) {
+  if (size <= 0)
+    throw ExceptionTools(ExceptionTools::GENERIC,
+                         "Size of channel " + name + " must be positive.");
+  for (std::size_t i = 0; i < channels.size(); ++i)
+    if (channels[i].name == name)
+      throw ExceptionTools(ExceptionTools::GENERIC,
+                           "Channel " + name + " already exists.");
+
+  const std::string prefix = "FilterBank(" + getName() + ")::";
+  Channel c;
+  c.name = name;
+  c.derivative = isDerivative;
+  c.offset = isDerivative ? derivative.size() : average.size();
+  c.size = size;
+  c.sin = new SignalIn_t(NULL, prefix + "input(vector)::sin_" + name);
+  c.sout = new SignalOut_t(
+      boost::bind(&FilterBank::computeOutput, this, _1, _2, channels.size()),
+      bankSINTERN, prefix + "output(vector)::sout_" + name);
+
+  signalRegistration(*c.sin << *c.sout);
+  bankSINTERN.addDependency(*c.sin);
+  channels.push_back(c);
+  return channels.back();
+}
+
+FilterBank::Channel &FilterBank::getChannel(const std::string &name) {
+  for (std::size_t i = 0; i < channels.size(); ++i)
+    if (channels[i].name == name)
+      return channels[i];
+  throw ExceptionTools(ExceptionTools::GENERIC,
+                       "No channel named " + name + ".");
+}
+
+void FilterBank::addAverage(const std::string &name, const int &size,
+                            const double &alpha_) {
+  const Channel &c = addChannel(name, size, false);
+  const Eigen::Index n = c.offset + c.size;
+  averageInput.conservativeResize(n);
+  average.conservativeResize(n);
+  alpha.conservativeResize(n);
+  oneMinusAlpha.conservativeResize(n);
+  average.segment(c.offset, c.size).setZero();
+  setAlpha(name, alpha_);
+}
+
+void FilterBank::addDerivative(const std::string &name, const int &size,
+                               const double &timestep) {
+  const Channel &c = addChannel(name, size, true);
+  newDerivatives.push_back(channels.size() - 1);
+  const Eigen::Index n = c.offset + c.size;
+  derivativeInput.conservativeResize(n);
+  derivativeMemory.conservativeResize(n);
+  derivative.conservativeResize(n);
+  invTimestep.conservativeResize(n);
+  setTimestep(name, timestep);
+}
+
+void FilterBank::setAlpha(const std::string &name, const double &alpha_) {
+  const Channel &c = getChannel(name);
+  if (c.derivative)
+    throw ExceptionTools(ExceptionTools::GENERIC,
+                         "Channel " + name + " is not an average.");
+  if (alpha_ < 0. || alpha_ > 1.)
+    throw ExceptionTools(ExceptionTools::GENERIC, "Alpha must be in [0,1].");
+  alpha.segment(c.offset, c.size).setConstant(alpha_);
+  oneMinusAlpha.segment(c.offset, c.size).setConstant(1. - alpha_);
+}
+
+void FilterBank::setTimestep(const std::string &name, const double &timestep) {
+  const Channel &c = getChannel(name);
+  if (!c.derivative)
+    throw ExceptionTools(ExceptionTools::GENERIC,
+                         "Channel " + name + " is not a derivative.");
+  if (timestep <= 0.)
+    throw ExceptionTools(ExceptionTools::GENERIC, "Timestep must be positive.");
+  invTimestep.segment(c.offset, c.size).setConstant(1. / timestep);
+}
+
+/* --- COMPUTE ----------------------------------------------------------- */
+
+int &FilterBank::computeBank(int &dummy, const int &time) {
+  for (std::size_t i = 0; i < channels.size(); ++i) {
+    const Channel &c = channels[i];
+    const Vector &in = c.sin->access(time);
+    if (in.size() != c.size)
+      throw ExceptionTools(ExceptionTools::GENERIC,
+                           "Wrong size of input signal " + c.sin->getName());
+    if (c.derivative)
+      derivativeInput.segment(c.offset, c.size) = in;
+    else
+      averageInput.segment(c.offset, c.size) = in;
+  }
+  for (std::size_t i = 0; i < newDerivatives.size(); ++i) {
+    const Channel &c = channels[newDerivatives[i]];
+    derivativeMemory.segment(c.offset, c.size) =
+        derivativeInput.segment(c.offset, c.size);
+  }
+  newDerivatives.clear();
+
+  average.array() = alpha.array() * average.array() +
+                    oneMinusAlpha.array() * averageInput.array();
+  derivative.array() = (derivativeInput.array() - derivativeMemory.array()) *
+                       invTimestep.array();
+  derivativeMemory.swap(derivativeInput);
+  return dummy;
+}
+
+Vector &FilterBank::computeOutput(Vector &res, const int &time,
+                                  const std::size_t i) {
+  bankSINTERN(time);
+  const Channel &c = channels[i];
+  if (c.derivative)
+    res = derivative.segment(c.offset, c.size);
+  else
+    res = average.segment(c.offset, c.size);
+  return res;
+}
+
+} /* namespace sot */
+} /* namespace dynamicgraph */
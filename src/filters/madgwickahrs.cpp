@@ -28,8 +28,10 @@ typedef Vector6d Vector6;
 
 #define PROFILE_MADGWICKAHRS_COMPUTATION "MadgwickAHRS computation"
 
-#define INPUT_SIGNALS m_accelerometerSIN << m_gyroscopeSIN
-#define OUTPUT_SIGNALS m_imu_quatSOUT
+#define INPUT_SIGNALS                                                          \
+  m_accelerometerSIN << m_gyroscopeSIN << m_accelerometer_batchSIN             \
+                     << m_gyroscope_batchSIN
+#define OUTPUT_SIGNALS m_imu_quatSOUT << m_imu_quat_batchSOUT
 
 /// Define EntityClassName here rather than in the header file
 /// so that it can be used by the macros DEFINE_SIGNAL_**_FUNCTION.
@@ -44,10 +46,13 @@ DYNAMICGRAPH_FACTORY_ENTITY_PLUGIN(MadgwickAHRS, "MadgwickAHRS");
 MadgwickAHRS::MadgwickAHRS(const std::string &name)
     : Entity(name), CONSTRUCT_SIGNAL_IN(accelerometer, dynamicgraph::Vector),
       CONSTRUCT_SIGNAL_IN(gyroscope, dynamicgraph::Vector),
-      CONSTRUCT_SIGNAL_OUT(imu_quat, dynamicgraph::Vector,
-                           m_gyroscopeSIN << m_accelerometerSIN),
+      CONSTRUCT_SIGNAL_IN(accelerometer_batch, dynamicgraph::Matrix),
+      CONSTRUCT_SIGNAL_IN(gyroscope_batch, dynamicgraph::Matrix),
+      CONSTRUCT_SIGNAL_OUT(imu_quat, dynamicgraph::Vector, INPUT_SIGNALS),
+      CONSTRUCT_SIGNAL_OUT(imu_quat_batch, dynamicgraph::Matrix,
+                           m_imu_quatSOUT),
       m_initSucceeded(false), m_beta(betaDef), m_q0(1.0), m_q1(0.0), m_q2(0.0),
-      m_q3(0.0), m_sampleFreq(512.0) {
+      m_q3(0.0), m_sampleFreq(512.0), m_samplePeriod(1.0 / 512.0) {
   Entity::signalRegistration(INPUT_SIGNALS << OUTPUT_SIGNALS);
 
   /* Commands. */
@@ -72,6 +77,7 @@ void MadgwickAHRS::init(const double &dt) {
   if (dt <= 0.0)
     return SEND_MSG("Timestep must be positive", MSG_TYPE_ERROR);
   m_sampleFreq = 1.0 / dt;
+  m_samplePeriod = dt;
   m_initSucceeded = true;
 }
 
@@ -99,26 +105,49 @@ DEFINE_SIGNAL_OUT_FUNCTION(imu_quat, dynamicgraph::Vector) {
         "Cannot compute signal imu_quat before initialization!");
     return s;
   }
-  const dynamicgraph::Vector &accelerometer = m_accelerometerSIN(iter);
-  const dynamicgraph::Vector &gyroscope = m_gyroscopeSIN(iter);
+  if (s.size() != 4)
+    s.resize(4);
 
-  getProfiler().start(PROFILE_MADGWICKAHRS_COMPUTATION);
-  {
+  if (m_accelerometer_batchSIN.isPlugged() &&
+      m_gyroscope_batchSIN.isPlugged()) {
+    const dynamicgraph::Matrix &accelerometer = m_accelerometer_batchSIN(iter);
+    const dynamicgraph::Matrix &gyroscope = m_gyroscope_batchSIN(iter);
+    if (accelerometer.rows() != 3 || gyroscope.rows() != 3 ||
+        accelerometer.cols() != gyroscope.cols()) {
+      SEND_WARNING_STREAM_MSG("Batches of accelerometer and gyroscope samples "
+                              "must be 3xN matrices of the same size!");
+      return s;
+    }
+
+    getProfiler().start(PROFILE_MADGWICKAHRS_COMPUTATION);
+    madgwickAHRSupdateIMUBatch(gyroscope, accelerometer);
+    getProfiler().stop(PROFILE_MADGWICKAHRS_COMPUTATION);
+  } else {
+    const dynamicgraph::Vector &accelerometer = m_accelerometerSIN(iter);
+    const dynamicgraph::Vector &gyroscope = m_gyroscopeSIN(iter);
+
+    getProfiler().start(PROFILE_MADGWICKAHRS_COMPUTATION);
     // Update state with new measurment
     madgwickAHRSupdateIMU(gyroscope(0), gyroscope(1), gyroscope(2),
                           accelerometer(0), accelerometer(1), accelerometer(2));
-    if (s.size() != 4)
-      s.resize(4);
-    s(0) = m_q0;
-    s(1) = m_q1;
-    s(2) = m_q2;
-    s(3) = m_q3;
+    m_quatBatch.resize(4, 1);
+    m_quatBatch << m_q0, m_q1, m_q2, m_q3;
+    getProfiler().stop(PROFILE_MADGWICKAHRS_COMPUTATION);
   }
-  getProfiler().stop(PROFILE_MADGWICKAHRS_COMPUTATION);
+  s(0) = m_q0;
+  s(1) = m_q1;
+  s(2) = m_q2;
+  s(3) = m_q3;
 
   return s;
 }
 
+DEFINE_SIGNAL_OUT_FUNCTION(imu_quat_batch, dynamicgraph::Matrix) {
+  m_imu_quatSOUT(iter);
+  s = m_quatBatch;
+  return s;
+}
+
 /* --- COMMANDS ------------------------------------------------------ */
 
 /* ------------------------------------------------------------------- */
@@ -202,10 +231,10 @@ void MadgwickAHRS::madgwickAHRSupdateIMU(double gx, double gy, double gz,
   }
 
   // Integrate rate of change of quaternion to yield quaternion
-  m_q0 += qDot1 * (1.0 / m_sampleFreq);
-  m_q1 += qDot2 * (1.0 / m_sampleFreq);
-  m_q2 += qDot3 * (1.0 / m_sampleFreq);
-  m_q3 += qDot4 * (1.0 / m_sampleFreq);
+  m_q0 += qDot1 * m_samplePeriod;
+  m_q1 += qDot2 * m_samplePeriod;
+  m_q2 += qDot3 * m_samplePeriod;
+  m_q3 += qDot4 * m_samplePeriod;
 
   // Normalise quaternion
   recipNorm = invSqrt(m_q0 * m_q0 + m_q1 * m_q1 + m_q2 * m_q2 + m_q3 * m_q3);
@@ -215,6 +244,24 @@ void MadgwickAHRS::madgwickAHRSupdateIMU(double gx, double gy, double gz,
   m_q3 *= recipNorm;
 }
 
+void MadgwickAHRS::madgwickAHRSupdateIMUBatch(
+    const dynamicgraph::Matrix &gyroscope,
+    const dynamicgraph::Matrix &accelerometer) {
+  const Eigen::Index n = gyroscope.cols();
+  m_quatBatch.resize(4, n);
+  // Column major storage: sample j is stored contiguously at data() + 3 j.
+  const double *g = gyroscope.data();
+  const double *a = accelerometer.data();
+  double *q = m_quatBatch.data();
+  for (Eigen::Index j = 0; j < n; ++j, g += 3, a += 3, q += 4) {
+    madgwickAHRSupdateIMU(g[0], g[1], g[2], a[0], a[1], a[2]);
+    q[0] = m_q0;
+    q[1] = m_q1;
+    q[2] = m_q2;
+    q[3] = m_q3;
+  }
+}
+
 /* ------------------------------------------------------------------- */
 /* --- ENTITY -------------------------------------------------------- */
 /* ------------------------------------------------------------------- */
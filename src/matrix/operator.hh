@@ -21,7 +21,6 @@
 #include <dynamic-graph/factory.h>
 
 #include <boost/numeric/conversion/cast.hpp>
-#include <deque>
 #include <dynamic-graph/linear-algebra.h>
 #include <sot/core/debug.hh>
 #include <sot/core/factory.hh>
@@ -663,38 +662,58 @@ struct Composer
 struct ConvolutionTemporal
     : public BinaryOpHeader<dynamicgraph::Vector, dynamicgraph::Matrix,
                             dynamicgraph::Vector> {
-  typedef std::deque<dynamicgraph::Vector> MemoryType;
-  MemoryType memory;
-
-  inline void convolution(const MemoryType &f1, const dynamicgraph::Matrix &f2,
-                          dynamicgraph::Vector &res) {
-    const Vector::Index nconv = (Vector::Index)f1.size(), nsig = f2.rows();
-    sotDEBUG(15) << "Size: " << nconv << "x" << nsig << std::endl;
-    if (nconv > f2.cols())
-      return; // TODO: error, this should not happen
-
-    res.resize(nsig);
-    res.fill(0);
-    unsigned int j = 0;
-    for (MemoryType::const_iterator iter = f1.begin(); iter != f1.end();
-         iter++) {
-      const dynamicgraph::Vector &s_tau = *iter;
-      sotDEBUG(45) << "Sig" << j << ": " << s_tau;
-      if (s_tau.size() != nsig)
-        return; // TODO: error throw;
-      for (int i = 0; i < nsig; ++i) {
-        res(i) += f2(i, j) * s_tau(i);
-      }
-      j++;
+  /// History of the input signal, stored in a ring buffer with one sample
+  /// per column: the sample of time t-j is column (head + j) % memory.cols(),
+  /// for j < nconv.
+  dynamicgraph::Matrix memory;
+  Matrix::Index head, nconv;
+
+  ConvolutionTemporal() : head(0), nconv(0) {}
+
+  /// Make room for nsig x ncols samples, keeping the most recent ones.
+  inline void resizeMemory(const Matrix::Index nsig,
+                           const Matrix::Index ncols) {
+    if (memory.rows() != nsig) {
+      memory.resize(nsig, ncols);
+      nconv = 0;
+    } else if (memory.cols() != ncols) {
+      const Matrix::Index keep = std::min(nconv, ncols);
+      dynamicgraph::Matrix ordered(nsig, ncols);
+      for (Matrix::Index j = 0; j < keep; ++j)
+        ordered.col(j) = memory.col((head + j) % memory.cols());
+      memory.swap(ordered);
+      nconv = keep;
     }
+    head = 0;
   }
+
   inline void operator()(const dynamicgraph::Vector &v1,
                          const dynamicgraph::Matrix &m2,
                          dynamicgraph::Vector &res) {
-    memory.push_front(v1);
-    while ((Vector::Index)memory.size() > m2.cols())
-      memory.pop_back();
-    convolution(memory, m2, res);
+    const Matrix::Index nsig = m2.rows(), ncols = m2.cols();
+    sotDEBUG(15) << "Size: " << nconv << "x" << nsig << std::endl;
+    res.resize(nsig);
+    res.setZero();
+    if (v1.size() != nsig)
+      throw std::invalid_argument(
+          "Convolution kernel and signal have different sizes.");
+    if (ncols == 0)
+      return;
+    if (memory.rows() != nsig || memory.cols() != ncols)
+      resizeMemory(nsig, ncols);
+
+    head = (head == 0 ? ncols : head) - 1;
+    memory.col(head) = v1;
+    if (nconv < ncols)
+      ++nconv;
+
+    // res = sum_j m2.col(j) .* s(t-j), the samples from head to the end of
+    // the buffer first, then the ones wrapped around at its beginning.
+    const Matrix::Index n1 = std::min(nconv, ncols - head);
+    for (Matrix::Index j = 0; j < n1; ++j)
+      res.array() += m2.col(j).array() * memory.col(head + j).array();
+    for (Matrix::Index j = n1; j < nconv; ++j)
+      res.array() += m2.col(j).array() * memory.col(j - n1).array();
   }
 };
 
@@ -1,6 +1,7 @@
 #include "dynamic-graph/python/module.hh"
 #include "dynamic-graph/python/signal.hh"
 
+#include <sot/core/debug.hh>
 #include <sot/core/device.hh>
 #include <sot/core/flags.hh>
 
@@ -99,4 +100,17 @@ BOOST_PYTHON_MODULE(wrap) {
       });
 
   dg::python::exposeSignalsOfType<Flags, int>("Flags");
+
+  bp::enum_<dgs::DebugModule>("DebugModule")
+      .value("solver", dgs::DEBUG_SOLVER)
+      .value("feature", dgs::DEBUG_FEATURE)
+      .value("task", dgs::DEBUG_TASK)
+      .value("filter", dgs::DEBUG_FILTER)
+      .value("tools", dgs::DEBUG_TOOLS);
+  bp::def("setDebugLevel", &dgs::DebugTrace::setLevel,
+          "Set the level up to which the compiled debug messages of a module "
+          "are written.");
+  bp::def("getDebugLevel", &dgs::DebugTrace::getLevel,
+          "Get the level up to which the compiled debug messages of a module "
+          "are written.");
 }
@@ -81,15 +81,20 @@ dgsot::Trajectory SignalCast<dgsot::Trajectory>::cast(std::istringstream &iss) {
     iss >> aTraj.joint_names_[idJoints];
 
   // Read nb of points
-  std::vector<JointTrajectoryPoint>::size_type nb_points;
+  Eigen::Index nb_points;
   iss >> nb_points;
 
-  // Read points
-  for (std::vector<JointTrajectoryPoint>::size_type idPoint = 0;
-       idPoint < nb_points; idPoint++) {
+  // Read points. Only the positions are given: the other quantities have
+  // no rows but one column per point.
+  aTraj.positions_.resize(nb_joints, nb_points);
+  aTraj.velocities_.resize(0, nb_points);
+  aTraj.accelerations_.resize(0, nb_points);
+  aTraj.efforts_.resize(0, nb_points);
+  aTraj.times_from_start_.setZero(nb_points);
+  for (Eigen::Index idPoint = 0; idPoint < nb_points; idPoint++) {
     // Read positions.
-    for (std::vector<double>::size_type idPos = 0; idPos < nb_joints; idPos++)
-      iss >> aTraj.points_[idPoint].positions_[idPos];
+    for (Eigen::Index idPos = 0; idPos < nb_joints; idPos++)
+      iss >> aTraj.positions_(idPos, idPoint);
     // TODO: read velocities and accelerations.
   }
   return aTraj;
@@ -103,36 +108,31 @@ void SignalCast<dgsot::Trajectory>::disp(const dgsot::Trajectory &aTraj,
     os << idJoints << " - " << aTraj.joint_names_[idJoints] << std::endl;
   }
   // Display points
-  os << "Number of points: " << aTraj.points_.size() << std::endl;
-  for (std::vector<JointTrajectoryPoint>::size_type idPoint = 0;
-       idPoint < aTraj.points_.size(); idPoint++) {
-    if (aTraj.points_[idPoint].positions_.size() != 0) {
+  os << "Number of points: " << aTraj.nbPoints() << std::endl;
+  for (std::size_t idPoint = 0; idPoint < aTraj.nbPoints(); idPoint++) {
+    const dgsot::Trajectory::ConstPoint point = aTraj.point(idPoint);
+    if (point.positions_.size() != 0) {
       os << " Point " << idPoint << " - Pos: [";
       // Read positions.
-      for (std::vector<double>::size_type idPos = 0;
-           idPos < aTraj.points_[idPoint].positions_.size(); idPos++) {
-        os << "(" << idPos << " : " << aTraj.points_[idPoint].positions_[idPos]
-           << ") ";
+      for (Eigen::Index idPos = 0; idPos < point.positions_.size(); idPos++) {
+        os << "(" << idPos << " : " << point.positions_(idPos) << ") ";
       }
       os << "] ";
     }
-    if (aTraj.points_[idPoint].velocities_.size() != 0) {
+    if (point.velocities_.size() != 0) {
       os << " Velocities " << idPoint << " - Pos: [";
       // Read positions.
-      for (std::vector<double>::size_type idPos = 0;
-           idPos < aTraj.points_[idPoint].velocities_.size(); idPos++) {
-        os << "(" << idPos << " : " << aTraj.points_[idPoint].velocities_[idPos]
-           << ") ";
+      for (Eigen::Index idPos = 0; idPos < point.velocities_.size(); idPos++) {
+        os << "(" << idPos << " : " << point.velocities_(idPos) << ") ";
       }
       os << "] ";
     }
-    if (aTraj.points_[idPoint].accelerations_.size() != 0) {
+    if (point.accelerations_.size() != 0) {
       os << " Velocities " << idPoint << " - Pos: [";
       // Read positions.
-      for (std::vector<double>::size_type idPos = 0;
-           idPos < aTraj.points_[idPoint].accelerations_.size(); idPos++) {
-        os << "(" << idPos << " : "
-           << aTraj.points_[idPoint].accelerations_[idPos] << ") ";
+      for (Eigen::Index idPos = 0; idPos < point.accelerations_.size();
+           idPos++) {
+        os << "(" << idPos << " : " << point.accelerations_(idPos) << ") ";
       }
       os << "] ";
     }
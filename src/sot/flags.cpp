@@ -26,10 +26,12 @@ using namespace dynamicgraph::sot;
 /* --- CLASS ----------------------------------------------------------- */
 /* --------------------------------------------------------------------- */
 
-Flags::Flags(const bool &b) : flags(), outOfRangeFlag(b) {}
+Flags::Flags(const bool &b)
+    : flags(), outOfRangeFlag(b), selected(), selectedSize(-1) {}
 
 Flags::Flags(const char *_flags)
-    : flags(strlen(_flags)), outOfRangeFlag(false) {
+    : flags(strlen(_flags)), outOfRangeFlag(false), selected(),
+      selectedSize(-1) {
   for (unsigned int i = 0; i < flags.size(); ++i) {
     switch (_flags[i]) {
     case '0':
@@ -48,7 +50,7 @@ Flags::Flags(const char *_flags)
 }
 
 Flags::Flags(const std::vector<bool> &_flags)
-    : flags(_flags), outOfRangeFlag(false) {}
+    : flags(_flags), outOfRangeFlag(false), selected(), selectedSize(-1) {}
 
 Flags::operator bool(void) const {
   if (outOfRangeFlag)
@@ -68,17 +70,34 @@ bool Flags::operator()(const int &i) const {
 }
 
 /* --------------------------------------------------------------------- */
-void Flags::add(const bool &b) { flags.push_back(b); }
+void Flags::add(const bool &b) {
+  flags.push_back(b);
+  invalidate();
+}
 
 /* --------------------------------------------------------------------- */
 void Flags::set(const unsigned int &idx) {
   if (idx < flags.size())
     flags[idx] = true;
+  invalidate();
 }
 
 void Flags::unset(const unsigned int &idx) {
   if (idx < flags.size())
     flags[idx] = false;
+  invalidate();
+}
+
+/* --------------------------------------------------------------------- */
+const Flags::Indices_t &Flags::selectedIndices(const Eigen::Index &size) const {
+  if (selectedSize != size) {
+    selected.clear();
+    for (Eigen::Index i = 0; i < size; ++i)
+      if (operator()(static_cast<int>(i)))
+        selected.push_back(i);
+    selectedSize = size;
+  }
+  return selected;
 }
 
 namespace dynamicgraph {
@@ -89,6 +108,7 @@ Flags Flags::operator!(void) const {
   Flags res = *this;
   res.flags.flip();
   res.outOfRangeFlag = !outOfRangeFlag;
+  res.invalidate();
   return res;
 }
 
@@ -112,6 +132,7 @@ Flags &Flags::operator&=(const Flags &f2) {
   for (auto i = f2.flags.size(); i < flags.size(); ++i)
     flags[i] = flags[i] & f2.outOfRangeFlag;
   outOfRangeFlag = outOfRangeFlag && f2.outOfRangeFlag;
+  invalidate();
   return *this;
 }
 
@@ -123,6 +144,7 @@ Flags &Flags::operator|=(const Flags &f2) {
   for (auto i = f2.flags.size(); i < flags.size(); ++i)
     flags[i] = flags[i] | f2.outOfRangeFlag;
   outOfRangeFlag = outOfRangeFlag || f2.outOfRangeFlag;
+  invalidate();
   return *this;
 }
 
@@ -136,6 +158,7 @@ std::ostream &operator<<(std::ostream &os, const Flags &fl) {
 std::istream &operator>>(std::istream &is, Flags &fl) {
   char c;
   fl.flags.clear();
+  fl.invalidate();
   while (is.get(c).good()) {
     switch (c) {
     case '0':
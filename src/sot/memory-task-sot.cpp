@@ -14,7 +14,7 @@ using namespace dynamicgraph::sot;
 using namespace dynamicgraph;
 
 MemoryTaskSOT::MemoryTaskSOT(const Matrix::Index nJ, const Matrix::Index mJ)
-    : kernel(NULL, 0, 0) {
+    : kernel(NULL, 0, 0), topologyVersion(0) {
   initMemory(nJ, mJ);
 }
 
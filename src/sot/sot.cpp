@@ -380,19 +380,32 @@ bool isFullPostureTask(Task *task, const Matrix::Index &nDof,
     return false;
   FeaturePosture *posture =
       dynamic_cast<FeaturePosture *>(task->getFeatureList().front());
+  if (posture == NULL)
+    return false;
 
-  assert(posture->dimensionSOUT(iterTime) <= nDof - 6);
-  return posture != NULL && posture->dimensionSOUT(iterTime) == nDof - 6;
+  // The dimension of the task is cached until the topology of the posture
+  // feature changes.
+  const Matrix::Index dim = task->getTaskDimension(iterTime);
+  assert(dim <= nDof - 6);
+  return dim == nDof - 6;
 }
 
-MemoryTaskSOT *getMemory(TaskAbstract &t, const Matrix::Index &tDim,
-                         const Matrix::Index &nDof) {
+MemoryTaskSOT *getMemory(TaskAbstract &t, Task *task,
+                         const Matrix::Index &tDim, const Matrix::Index &nDof,
+                         const int &iterTime) {
+  // The memory of a Task is only reallocated when its topology changes.
+  const unsigned int version =
+      (task != NULL ? task->getTopologyVersion(iterTime) : 0);
   MemoryTaskSOT *mem = dynamic_cast<MemoryTaskSOT *>(t.memoryInternal);
   if (NULL == mem) {
     if (NULL != t.memoryInternal)
       delete t.memoryInternal;
     mem = new MemoryTaskSOT(tDim, nDof);
+    mem->topologyVersion = version;
     t.memoryInternal = mem;
+  } else if (mem->topologyVersion != version) {
+    mem->initMemory(tDim, nDof);
+    mem->topologyVersion = version;
   }
   return mem;
 }
@@ -531,7 +544,7 @@ dynamicgraph::Vector &Sot::computeControlLaw(dynamicgraph::Vector &control,
     sotCOUNTER(0, 1); // Direct Dynamic
 
     /* Init memory. */
-    MemoryTaskSOT *mem = getMemory(taskA, dim, nbJoints);
+    MemoryTaskSOT *mem = getMemory(taskA, task, dim, nbJoints, iterTime);
     /***/ sotCOUNTER(1, 2); // first allocs
 
     Matrix::Index rankJ = -1;
@@ -32,6 +32,8 @@ DYNAMICGRAPH_FACTORY_ENTITY_PLUGIN(Task, "Task");
 
 Task::Task(const std::string &n)
     : TaskAbstract(n), featureList(), withDerivative(false),
+      featureOffsets(1, 0), featureListVersion(1), layoutListVersion(0),
+      layoutFeaturesVersion(0), topologyVersion(0),
       controlGainSIN(NULL, "sotTask(" + n + ")::input(double)::controlGain"),
       dampingGainSINOUT(NULL, "sotTask(" + n + ")::in/output(double)::damping")
       // TODO As far as I understand, this is not used in this class.
@@ -101,6 +103,7 @@ void Task::initCommands(void) {
 
 void Task::addFeature(FeatureAbstract &s) {
   featureList.push_back(&s);
+  ++featureListVersion;
   jacobianSOUT.addDependency(s.jacobianSOUT);
   errorSOUT.addDependency(s.errorSOUT);
   errorTimeDerivativeSOUT.addDependency(s.getErrorDot());
@@ -123,6 +126,7 @@ void Task::clearFeatureList(void) {
   }
 
   featureList.clear();
+  ++featureListVersion;
 }
 
 void Task::setControlSelection(const Flags &act) { controlSelectionSIN = act; }
@@ -136,6 +140,39 @@ void Task::clearControlSelection(void) { controlSelectionSIN = Flags(false); }
 void Task::setWithDerivative(const bool &s) { withDerivative = s; }
 bool Task::getWithDerivative(void) { return withDerivative; }
 
+/* --- LAYOUT --------------------------------------------------------------- */
+
+void Task::updateLayout(int time) {
+  unsigned int featuresVersion = 0;
+  for (FeatureList_t::iterator iter = featureList.begin();
+       iter != featureList.end(); ++iter)
+    featuresVersion += (*iter)->getTopologyVersion(time);
+
+  if (layoutListVersion == featureListVersion &&
+      layoutFeaturesVersion == featuresVersion)
+    return;
+
+  featureOffsets.resize(featureList.size() + 1);
+  std::size_t k = 0;
+  for (FeatureList_t::iterator iter = featureList.begin();
+       iter != featureList.end(); ++iter, ++k)
+    featureOffsets[k + 1] = featureOffsets[k] + (*iter)->dimensionSOUT(time);
+
+  layoutListVersion = featureListVersion;
+  layoutFeaturesVersion = featuresVersion;
+  ++topologyVersion;
+}
+
+unsigned int Task::getTopologyVersion(int time) {
+  updateLayout(time);
+  return topologyVersion;
+}
+
+dynamicgraph::Vector::Index Task::getTaskDimension(int time) {
+  updateLayout(time);
+  return featureOffsets.back();
+}
+
 /* --- COMPUTATION ---------------------------------------------------------- */
 /* --- COMPUTATION ---------------------------------------------------------- */
 /* --- COMPUTATION ---------------------------------------------------------- */
@@ -149,56 +186,31 @@ dynamicgraph::Vector &Task::computeError(dynamicgraph::Vector &error,
   }
 
   try {
-    /* The vector dimensions are not known before the affectation loop.
-     * They thus should be allocated on the flight, in the loop.
-     * The first assumption is that the size has not changed. A double
-     * reallocation (realloc(dim*2)) is done if necessary. In particulary,
-     * [log_2(dim)+1] reallocations are done for the first error computation.
-     * If the allocated size is too large, a correction is done after the loop.
-     * The algotithmic cost is linear in affectation, logarthmic in allocation
-     * numbers and linear in allocation size.
-     * No assumptions are made concerning size of each vector: they are
-     * not said equal, and could be different.
-     */
-
-    /* First assumption: vector dimensions have not changed. If 0, they are
-     * initialized to dim 1.*/
-    dynamicgraph::Vector::Index dimError = error.size();
-    if (0 == dimError) {
-      dimError = 1;
-      error.resize(dimError);
-      error.setZero();
-    }
+    /* The layout of the error only changes with the topology of the
+     * features, so that it is not reallocated at each time step. */
+    updateLayout(time);
+    error.resize(featureOffsets.back());
 
-    dynamicgraph::Vector vectTmp;
-    int cursorError = 0;
-
-    /* For each cell of the list, recopy value of s, s_star and error. */
+    std::size_t k = 0;
     for (FeatureList_t::iterator iter = featureList.begin();
-         iter != featureList.end(); ++iter) {
+         iter != featureList.end(); ++iter, ++k) {
       FeatureAbstract &feature = **iter;
 
-      /* Get s, and store it in the s vector. */
       sotDEBUG(45) << "Feature <" << feature.getName() << ">." << std::endl;
       const dynamicgraph::Vector &partialError = feature.errorSOUT(time);
 
-      const dynamicgraph::Vector::Index dim = partialError.size();
-      while (cursorError + dim > dimError) // DEBUG It was >=
-      {
-        dimError *= 2;
-        error.resize(dimError);
-        error.setZero();
-      }
-
-      for (int k = 0; k < dim; ++k) {
-        error(cursorError++) = partialError(k);
-      }
+      const dynamicgraph::Vector::Index dim =
+          featureOffsets[k + 1] - featureOffsets[k];
+      if (partialError.size() != dim)
+        throw ExceptionTask(ExceptionTask::NON_ADEQUATE_FEATURES,
+                            "Size of the error of feature " +
+                                feature.getName() +
+                                " does not match its dimension.");
+
+      error.segment(featureOffsets[k], dim) = partialError;
       sotDEBUG(35) << "feature: " << partialError << std::endl;
       sotDEBUG(35) << "error: " << error << std::endl;
     }
-
-    /* If too much memory has been allocated, resize. */
-    error.conservativeResize(cursorError);
   } catch SOT_RETHROW;
 
   sotDEBUG(35) << "error_final: " << error << std::endl;
@@ -252,55 +264,35 @@ dynamicgraph::Matrix &Task::computeJacobian(dynamicgraph::Matrix &J, int time) {
   }
 
   try {
-    dynamicgraph::Matrix::Index dimJ = J.rows();
-    dynamicgraph::Matrix::Index nbc = J.cols();
-    if (0 == dimJ) {
-      dimJ = 1;
-      J.resize(dimJ, nbc);
-    }
+    updateLayout(time);
+    const dynamicgraph::Matrix::Index nbc =
+        featureList.front()->jacobianSOUT(time).cols();
+    J.resize(featureOffsets.back(), nbc);
 
-    dynamicgraph::Matrix::Index cursorJ = 0;
-    // const Flags& selection = controlSelectionSIN(time);
-
-    /* For each cell of the list, recopy value of s, s_star and error. */
+    /* For each feature of the list, copy its Jacobian as a block of rows. */
+    std::size_t k = 0;
     for (FeatureList_t::iterator iter = featureList.begin();
-         iter != featureList.end(); ++iter) {
+         iter != featureList.end(); ++iter, ++k) {
       FeatureAbstract &feature = **iter;
       sotDEBUG(25) << "Feature <" << feature.getName() << ">" << endl;
 
-      /* Get s, and store it in the s vector. */
       const dynamicgraph::Matrix &partialJacobian = feature.jacobianSOUT(time);
-      const dynamicgraph::Matrix::Index nbr = partialJacobian.rows();
+      const dynamicgraph::Matrix::Index nbr =
+          featureOffsets[k + 1] - featureOffsets[k];
       sotDEBUG(25) << "Jp =" << endl << partialJacobian << endl;
 
-      if (0 == nbc) {
-        nbc = partialJacobian.cols();
-        J.resize(nbc, dimJ);
-      } else if (partialJacobian.cols() != nbc)
+      if (partialJacobian.cols() != nbc)
         throw ExceptionTask(
             ExceptionTask::NON_ADEQUATE_FEATURES,
             "Features from the list don't have compatible-size jacobians.");
+      if (partialJacobian.rows() != nbr)
+        throw ExceptionTask(ExceptionTask::NON_ADEQUATE_FEATURES,
+                            "Size of the Jacobian of feature " +
+                                feature.getName() +
+                                " does not match its dimension.");
 
-      while (cursorJ + nbr >= dimJ) {
-        dimJ *= 2;
-        J.conservativeResize(dimJ, nbc);
-      }
-      // TODO If controlSelectionSIN is really to be removed,
-      // then the following loop is equivalent to:
-      // J.middleRows (cursorJ, nbr) = partialJacobian;
-      for (int kc = 0; kc < nbc; ++kc) {
-        // 	  if( selection(kc) )
-        for (unsigned int k = 0; k < nbr; ++k) {
-          J(cursorJ + k, kc) = partialJacobian(k, kc);
-        }
-        // 	  else
-        // 	    for( unsigned int k=0;k<nbr;++k ) J(cursorJ+k,kc) = 0.;
-      }
-      cursorJ += nbr;
+      J.middleRows(featureOffsets[k], nbr) = partialJacobian;
     }
-
-    /* If too much memory has been allocated, resize. */
-    J.conservativeResize(cursorJ, nbc);
   } catch SOT_RETHROW;
 
   sotDEBUG(15) << "# Out }" << endl;
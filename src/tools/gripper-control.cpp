@@ -159,19 +159,7 @@ GripperControl::computeDesiredPosition(const dynamicgraph::Vector &currentPos,
 dynamicgraph::Vector &
 GripperControl::selector(const dynamicgraph::Vector &fullsize,
                          const Flags &selec, dynamicgraph::Vector &desPos) {
-  int size = 0;
-  for (int i = 0; i < fullsize.size(); ++i) {
-    if (selec(i))
-      size++;
-  }
-
-  int curs = 0;
-  desPos.resize(size);
-  for (int i = 0; i < fullsize.size(); ++i) {
-    if (selec(i))
-      desPos(curs++) = fullsize(i);
-  }
-
+  selec.gatherRows(fullsize, desPos);
   return desPos;
 }
 
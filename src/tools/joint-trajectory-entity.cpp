@@ -21,6 +21,7 @@ sotJTE__INIT sotJTE_initiator;
 #include <dynamic-graph/command-bind.h>
 #include <dynamic-graph/factory.h>
 
+#include <sot/core/exception-tools.hh>
 #include <sot/core/joint-trajectory-entity.hh>
 
 #include "joint-trajectory-command.hh"
@@ -59,10 +60,20 @@ SotJointTrajectoryEntity::SotJointTrajectoryEntity(const std::string &n)
                 "SotJointTrajectory(" + n + ")::output(uint)::seqid"),
       trajectorySIN(NULL, "SotJointTrajectory(" + n +
                               ")::input(trajectory)::trajectoryIN"),
-      index_(0), traj_timestamp_(0, 0), seqid_(0), deque_traj_(0) {
+      index_(0), traj_timestamp_(0, 0), seqid_(0), posted_(false),
+      settingsPosted_(false), queue_(4), queueHead_(0), queueSize_(0),
+      firstPoint_(false),
+      inputRead_(false), timed_(false),
+      interpolation_(Trajectory::INTERPOLATION_LINEAR), timestep_(0.),
+      clock_(0.), segment_(0), blendingWindow_(0), blendStep_(0) {
   using namespace command;
   sotDEBUGIN(5);
 
+  posted_settings_.timed = timed_;
+  posted_settings_.interpolation = interpolation_;
+  posted_settings_.timestep = timestep_;
+  posted_settings_.blendingWindow = blendingWindow_;
+
   signalRegistration(positionSOUT << comSOUT << zmpSOUT << waistSOUT
                                   << seqIdSOUT << trajectorySIN);
   refresherSINTERN.setDependencyType(TimeDependency<int>::ALWAYS_READY);
@@ -79,142 +90,305 @@ SotJointTrajectoryEntity::SotJointTrajectoryEntity(const std::string &n)
              makeCommandVoid1(*this, &SotJointTrajectoryEntity::setInitTraj,
                               docCommandVoid1("Set initial trajectory",
                                               "string (trajectory)")));
+  addCommand("loadFile",
+             makeCommandVoid1(
+                 *this, &SotJointTrajectoryEntity::loadFile,
+                 docCommandVoid1("Set initial trajectory from a binary file "
+                                 "(see Trajectory::serializeBinary)",
+                                 "string (file name)")));
+  addCommand("setInterpolation",
+             makeCommandVoid1(
+                 *this, &SotJointTrajectoryEntity::setInterpolation,
+                 docCommandVoid1("Set how the trajectory is played",
+                                 "string (none, linear, cubic or quintic)")));
+  addCommand("getInterpolation",
+             makeCommandReturnType0(
+                 *this, &SotJointTrajectoryEntity::getInterpolation,
+                 "Get how the trajectory is played."));
+  addCommand("setTimeStep",
+             makeCommandVoid1(
+                 *this, &SotJointTrajectoryEntity::setTimeStep,
+                 docCommandVoid1("Set the time step, used by the "
+                                 "interpolation",
+                                 "double (time step in seconds)")));
+  addCommand("getTimeStep",
+             makeCommandReturnType0(*this,
+                                    &SotJointTrajectoryEntity::getTimeStep,
+                                    "Get the time step in seconds."));
+  addCommand("setBlendingWindow",
+             makeCommandVoid1(
+                 *this, &SotJointTrajectoryEntity::setBlendingWindow,
+                 docCommandVoid1("Set the number of evaluations over which "
+                                 "a new trajectory is blended",
+                                 "int (blending window)")));
+  addCommand("getBlendingWindow",
+             makeCommandReturnType0(
+                 *this, &SotJointTrajectoryEntity::getBlendingWindow,
+                 "Get the blending window."));
   sotDEBUGOUT(5);
 }
 
-void SotJointTrajectoryEntity::UpdatePoint(const JointTrajectoryPoint &aJTP) {
+namespace {
+/// Time from stamp from to stamp to, in seconds. The stamps are subtracted
+/// before the conversion: a time since epoch has a resolution of about
+/// 2e-7 s in a double.
+double secondsBetween(const timestamp &from, const timestamp &to) {
+  return static_cast<double>(static_cast<long long>(to.secs_) -
+                             static_cast<long long>(from.secs_)) +
+         1e-9 * (static_cast<double>(to.nsecs_) -
+                 static_cast<double>(from.nsecs_));
+}
+
+void checkTimes(const Trajectory &aTrajectory) {
+  const dynamicgraph::Vector &times = aTrajectory.times_from_start_;
+  const Eigen::Index n = times.size();
+  if (n > 1 && !((times.tail(n - 1) - times.head(n - 1)).array() > 0).all())
+    throw ExceptionTools(ExceptionTools::GENERIC,
+                         "The times from start of the points must be "
+                         "strictly increasing.");
+}
+} // namespace
+
+void SotJointTrajectoryEntity::UpdatePoint(
+    const Eigen::Ref<const dynamicgraph::Vector> &positions) {
 
   sotDEBUGIN(5);
   // Posture
-  std::vector<JointTrajectoryPoint>::size_type possize = aJTP.positions_.size();
+  const Eigen::Index possize = positions.size();
   if (possize == 0)
     return;
 
-  pose_.resize(aJTP.positions_.size());
-  for (std::vector<JointTrajectoryPoint>::size_type i = 0; i < possize - 5;
-       i++) {
-    pose_(i) = aJTP.positions_[i];
-    sotDEBUG(5) << pose_(i) << " " << std::endl;
-  }
+  pose_.resize(possize);
+  pose_.head(possize - 5) = positions.head(possize - 5);
+  sotDEBUG(5) << pose_ << std::endl;
 
   // Center of Mass
-  com_.resize(3);
-  for (std::vector<JointTrajectoryPoint>::size_type i = possize - 5, j = 0;
-       i < possize - 2; i++, j++)
-    com_(j) = aJTP.positions_[i];
+  com_ = positions.segment(possize - 5, 3);
 
   sotDEBUG(5) << "com: " << com_ << std::endl;
 
   // Add a constant height TODO: make it variable
-  dynamicgraph::Vector waistXYZTheta;
-  waistXYZTheta.resize(4);
-
-  waistXYZTheta(0) = com_(0);
-  waistXYZTheta(1) = com_(1);
-  waistXYZTheta(2) = 0.65;
-  waistXYZTheta(3) = com_(2);
-  waist_ = XYZThetaToMatrixHomogeneous(waistXYZTheta);
+  waist_ = Eigen::AngleAxisd(com_(2), Eigen::Vector3d::UnitZ()) *
+           Eigen::Translation3d(com_(0), com_(1), 0.65);
 
   sotDEBUG(5) << "waist: " << waist_ << std::endl;
   // Center of Pressure
   cop_.resize(3);
-  for (std::vector<JointTrajectoryPoint>::size_type i = possize - 2, j = 0;
-       i < possize; i++, j++)
-    cop_(j) = aJTP.positions_[i];
+  cop_.head<2>() = positions.tail<2>();
   cop_(2) = -0.055;
   sotDEBUG(5) << "cop_: " << cop_ << std::endl;
   sotDEBUGOUT(5);
 }
 
-void SotJointTrajectoryEntity::UpdateTrajectory(const Trajectory &aTrajectory) {
+void SotJointTrajectoryEntity::UpdateTrajectory() {
   sotDEBUGIN(3);
-  sotDEBUG(3) << "traj_timestamp: " << traj_timestamp_
-              << " aTrajectory.header_.stamp_" << aTrajectory.header_.stamp_;
+  if (queueSize_ == 0)
+    return;
 
-  // Do we have the same trajectory, or are we at the initialization phase ?
-  if ((traj_timestamp_ == aTrajectory.header_.stamp_) &&
-      (deque_traj_.size() != 0))
+  // Move to the next point, unless the first one was not played yet.
+  if (firstPoint_)
+    firstPoint_ = false;
+  else
     index_++;
-  else {
-    // No we have a new trajectory.
-    sotDEBUG(3) << "index: " << index_ << " aTrajectory.points_.size(): "
-                << aTrajectory.points_.size();
 
-    // Put the new trajectory in the queue
-
-    // if there is nothing
-    if (deque_traj_.size() == 0) {
-      deque_traj_.push_back(aTrajectory);
-      index_ = 0;
-    } else {
-      index_++;
-      // if it is not already inside the queue.
-      if (deque_traj_.back().header_.stamp_ == aTrajectory.header_.stamp_) {
-      } else
-        deque_traj_.push_back(aTrajectory);
-    }
-  }
-
-  sotDEBUG(3) << "step 1 " << std::endl
-              << "header: " << std::endl
-              << "  timestamp:"
-              << static_cast<double>(aTrajectory.header_.stamp_.secs_) +
-                     0.000000001 *
-                         static_cast<double>(aTrajectory.header_.stamp_.nsecs_)
-              << " seq:" << aTrajectory.header_.seq_ << " "
-              << " frame_id:" << aTrajectory.header_.frame_id_
-              << " index_: " << index_
-              << " aTrajectory.points_.size():" << aTrajectory.points_.size()
+  sotDEBUG(3) << "index_: " << index_ << " queueSize_: " << queueSize_
               << std::endl;
 
   // Strategy at the end of the trajectory.
-  if (index_ >= deque_traj_.front().points_.size()) {
+  if (index_ >= QueueAt(0).nbPoints()) {
 
-    if (deque_traj_.size() > 1) {
-      deque_traj_.pop_front();
+    if (queueSize_ > 1) {
+      PopQueueFront();
       index_ = 0;
     }
 
     // If the new trajectory has a problem
-    if (deque_traj_.front().points_.size() == 0) {
+    if (QueueAt(0).nbPoints() == 0) {
       // then neutralize the entity
       index_ = 0;
-      sotDEBUG(3) << "current_traj_.points_.size()="
-                  << deque_traj_.front().points_.size() << std::endl;
+      sotDEBUG(3) << "current_traj_.nbPoints()="
+                  << QueueAt(0).nbPoints() << std::endl;
       return;
     }
 
     // Strategy at the end of the trajectory when no new information is
     // available: It is assumed that the last pose is balanced, and we keep
     // providing this pose to the robot.
-    if ((index_ != 0) && (deque_traj_.size() == 1)) {
-      index_ = deque_traj_.front().points_.size() - 1;
+    if ((index_ != 0) && (queueSize_ == 1)) {
+      index_ = QueueAt(0).nbPoints() - 1;
     }
-    sotDEBUG(3) << "index_=current_traj_.points_.size()-1;" << std::endl;
+    sotDEBUG(3) << "index_=current_traj_.nbPoints()-1;" << std::endl;
   }
 
-  sotDEBUG(3) << "index_:" << index_ << " current_traj_.points_.size():"
-              << deque_traj_.front().points_.size() << std::endl;
+  sotDEBUG(3) << "index_:" << index_ << " current_traj_.nbPoints():"
+              << QueueAt(0).nbPoints() << std::endl;
 
-  seqid_ = deque_traj_.front().header_.seq_;
-  UpdatePoint(deque_traj_.front().points_[index_]);
+  seqid_ = QueueAt(0).header_.seq_;
+  BlendAndUpdatePoint(QueueAt(0), QueueAt(0).positions_.col(index_));
   sotDEBUGOUT(3);
 }
 
+void SotJointTrajectoryEntity::UpdateTimedTrajectory() {
+  sotDEBUGIN(3);
+  if (queueSize_ == 0)
+    return;
+  if (timestep_ <= 0.)
+    throw ExceptionTools(ExceptionTools::GENERIC,
+                         "The time step of " + getName() + " is not set.");
+
+  // A trajectory replaces the current one once its stamp is reached. The
+  // segment is then out of range, which starts a binary search.
+  while (queueSize_ > 1) {
+    const double start = secondsBetween(QueueAt(0).header_.stamp_,
+                                        QueueAt(1).header_.stamp_);
+    if (start > clock_)
+      break;
+    clock_ -= start;
+    PopQueueFront();
+    segment_ = QueueAt(0).nbPoints();
+  }
+
+  const Trajectory &current = QueueAt(0);
+  seqid_ = current.header_.seq_;
+  if (current.nbPoints() == 0) {
+    sotDEBUG(3) << "Empty trajectory." << std::endl;
+    return;
+  }
+
+  current.interpolatePositions(clock_, interpolation_, segment_, sample_);
+  sotDEBUG(3) << "t: " << clock_ << " segment_: " << segment_ << std::endl;
+  BlendAndUpdatePoint(current, sample_);
+  sotDEBUGOUT(3);
+}
+
+void SotJointTrajectoryEntity::BlendAndUpdatePoint(
+    const Trajectory &current,
+    const Eigen::Ref<const dynamicgraph::Vector> &positions) {
+  // Start a blending when the played trajectory changes.
+  if (!(current.header_.stamp_ == playedStamp_)) {
+    playedStamp_ = current.header_.stamp_;
+    blendStep_ = blendingWindow_;
+    if ((blendingWindow_ > 0) && (output_.size() == positions.size())) {
+      blendOffset_ = output_ - positions;
+      blendStep_ = 0;
+    }
+  }
+
+  if (blendStep_ < blendingWindow_) {
+    ++blendStep_;
+    const double s = static_cast<double>(blendStep_) / blendingWindow_;
+    output_ = positions + (1 - s * s * (3 - 2 * s)) * blendOffset_;
+  } else
+    output_ = positions;
+  UpdatePoint(output_);
+}
+
+void SotJointTrajectoryEntity::postTrajectory(Trajectory &trajectory) {
+  boost::mutex::scoped_lock lock(postedMutex_);
+  if (posted_settings_.timed)
+    checkTimes(trajectory);
+  posted_traj_.swap(trajectory);
+  posted_ = true;
+}
+
+bool SotJointTrajectoryEntity::TakePostedTrajectory() {
+  boost::mutex::scoped_try_lock lock(postedMutex_);
+  if (!lock.owns_lock() || !posted_)
+    return false;
+  taken_traj_.swap(posted_traj_);
+  posted_ = false;
+  return true;
+}
+
+void SotJointTrajectoryEntity::ApplyPostedSettings() {
+  boost::mutex::scoped_try_lock lock(postedMutex_);
+  if (!lock.owns_lock() || !settingsPosted_)
+    return;
+  settingsPosted_ = false;
+
+  const bool wasTimed = timed_;
+  timed_ = posted_settings_.timed;
+  interpolation_ = posted_settings_.interpolation;
+  timestep_ = posted_settings_.timestep;
+  blendingWindow_ = posted_settings_.blendingWindow;
+
+  // Start the clock at the time of the current point.
+  if (timed_ && !wasTimed && queueSize_ != 0) {
+    const Trajectory &current = QueueAt(0);
+    clock_ = 0.;
+    if (index_ < current.nbPoints())
+      clock_ = current.times_from_start_(index_);
+    segment_ = current.nbPoints();
+  }
+}
+
+Trajectory *SotJointTrajectoryEntity::AppendToQueue(const timestamp &stamp) {
+  if ((queueSize_ != 0) && (QueueAt(queueSize_ - 1).header_.stamp_ == stamp))
+    return NULL;
+  // All the slots are used: the trajectories are moved to a larger ring.
+  if (queueSize_ == queue_.size()) {
+    std::vector<Trajectory> larger(2 * queue_.size());
+    for (std::size_t i = 0; i < queueSize_; ++i)
+      larger[i].swap(QueueAt(i));
+    queue_.swap(larger);
+    queueHead_ = 0;
+  }
+  ++queueSize_;
+  // The first trajectory is played from its first point, and the clock
+  // starts at its stamp.
+  if (queueSize_ == 1) {
+    index_ = 0;
+    firstPoint_ = true;
+    clock_ = 0.;
+    segment_ = 0;
+  }
+  return &QueueAt(queueSize_ - 1);
+}
+
+void SotJointTrajectoryEntity::PopQueueFront() {
+  queueHead_ = (queueHead_ + 1) % queue_.size();
+  --queueSize_;
+}
+
 int &SotJointTrajectoryEntity::OneStepOfUpdate(int &dummy, const int &time) {
   sotDEBUGIN(4);
+  ApplyPostedSettings();
+  if (timed_ && (queueSize_ != 0))
+    clock_ += timestep_;
+
+  // A trajectory posted by a command is queued as if it was read before
+  // trajectorySIN. Its storage is moved in the queue, without any copy,
+  // and the retired trajectory of the slot is given back to the command
+  // thread by the next postTrajectory.
+  if (TakePostedTrajectory()) {
+    if (timed_)
+      checkTimes(taken_traj_);
+    Trajectory *queued = AppendToQueue(taken_traj_.header_.stamp_);
+    if (queued != NULL)
+      queued->swap(taken_traj_);
+  }
+
   const Trajectory &atraj = trajectorySIN(time);
-  if ((atraj.header_.stamp_.secs_ !=
-       deque_traj_.front().header_.stamp_.secs_) ||
-      (atraj.header_.stamp_.nsecs_ !=
-       deque_traj_.front().header_.stamp_.nsecs_)) {
-    if (index_ < deque_traj_.front().points_.size() - 1) {
+  if (!inputRead_ || !(atraj.header_.stamp_ == inputStamp_)) {
+    // A wrong trajectory is reported once.
+    inputRead_ = true;
+    inputStamp_ = atraj.header_.stamp_;
+    if (timed_)
+      checkTimes(atraj);
+    if ((queueSize_ != 0) && (index_ + 1 < QueueAt(0).nbPoints())) {
       sotDEBUG(4) << "Overwrite trajectory without completion." << index_ << " "
-                  << deque_traj_.front().points_.size() << std::endl;
+                  << QueueAt(0).nbPoints() << std::endl;
     }
+    Trajectory *queued = AppendToQueue(atraj.header_.stamp_);
+    if (queued != NULL)
+      *queued = atraj;
   }
   sotDEBUG(4) << "Finished to read trajectorySIN" << std::endl;
-  UpdateTrajectory(atraj);
+
+  if (timed_)
+    UpdateTimedTrajectory();
+  else
+    UpdateTrajectory();
 
   sotDEBUG(4) << "Finished to update trajectory" << std::endl;
 
@@ -287,12 +461,73 @@ unsigned int &SotJointTrajectoryEntity::getSeqId(unsigned int &seqid,
   return seqid;
 }
 
-void SotJointTrajectoryEntity::loadFile(const std::string &) {
+void SotJointTrajectoryEntity::loadFile(const std::string &filename) {
   sotDEBUGIN(5);
-  // TODO
+  init_traj_.loadBinaryFile(filename);
+  postTrajectory(init_traj_);
   sotDEBUGOUT(5);
 }
 
+void SotJointTrajectoryEntity::setInterpolation(
+    const std::string &interpolation) {
+  bool timed = true;
+  Trajectory::Interpolation method = Trajectory::INTERPOLATION_LINEAR;
+  if (interpolation == "none")
+    timed = false;
+  else if (interpolation == "linear")
+    method = Trajectory::INTERPOLATION_LINEAR;
+  else if (interpolation == "cubic")
+    method = Trajectory::INTERPOLATION_CUBIC;
+  else if (interpolation == "quintic")
+    method = Trajectory::INTERPOLATION_QUINTIC;
+  else
+    throw ExceptionTools(ExceptionTools::GENERIC,
+                         "Unknown interpolation " + interpolation +
+                             ", expected none, linear, cubic or quintic.");
+
+  boost::mutex::scoped_lock lock(postedMutex_);
+  posted_settings_.timed = timed;
+  if (timed)
+    posted_settings_.interpolation = method;
+  settingsPosted_ = true;
+}
+
+std::string SotJointTrajectoryEntity::getInterpolation() const {
+  boost::mutex::scoped_lock lock(postedMutex_);
+  if (!posted_settings_.timed)
+    return "none";
+  switch (posted_settings_.interpolation) {
+  case Trajectory::INTERPOLATION_CUBIC:
+    return "cubic";
+  case Trajectory::INTERPOLATION_QUINTIC:
+    return "quintic";
+  default:
+    return "linear";
+  }
+}
+
+void SotJointTrajectoryEntity::setTimeStep(const double &timestep) {
+  boost::mutex::scoped_lock lock(postedMutex_);
+  posted_settings_.timestep = timestep;
+  settingsPosted_ = true;
+}
+
+double SotJointTrajectoryEntity::getTimeStep() const {
+  boost::mutex::scoped_lock lock(postedMutex_);
+  return posted_settings_.timestep;
+}
+
+void SotJointTrajectoryEntity::setBlendingWindow(const int &blendingWindow) {
+  boost::mutex::scoped_lock lock(postedMutex_);
+  posted_settings_.blendingWindow = blendingWindow;
+  settingsPosted_ = true;
+}
+
+int SotJointTrajectoryEntity::getBlendingWindow() const {
+  boost::mutex::scoped_lock lock(postedMutex_);
+  return posted_settings_.blendingWindow;
+}
+
 void SotJointTrajectoryEntity::display(std::ostream &os) const {
   sotDEBUGIN(5);
   os << this;
@@ -301,9 +536,8 @@ void SotJointTrajectoryEntity::display(std::ostream &os) const {
 
 void SotJointTrajectoryEntity::setInitTraj(const std::string &as) {
   sotDEBUGIN(5);
-  std::istringstream is(as);
-  init_traj_.deserialize(is);
-  UpdateTrajectory(init_traj_);
+  init_traj_.deserialize(as);
+  postTrajectory(init_traj_);
 
   sotDEBUGOUT(5);
 }
@@ -16,6 +16,7 @@
 #include <sot/core/factory.hh>
 #include <sot/core/kalman.hh> /* Header of the class implemented here.   */
 
+#include <dynamic-graph/command-bind.h>
 #include <dynamic-graph/command-setter.h>
 
 namespace dynamicgraph {
@@ -29,14 +30,17 @@ Kalman::Kalman(const std::string &name)
       modelTransitionSIN(NULL, "Kalman(" + name + ")::input(matrix)::F"),
       modelMeasureSIN(NULL, "Kalman(" + name + ")::input(matrix)::H"),
       noiseTransitionSIN(NULL, "Kalman(" + name + ")::input(matrix)::Q"),
-      noiseMeasureSIN(NULL, "Kalman(" + name + ")::input(matrix)::R")
+      noiseMeasureSIN(NULL, "Kalman(" + name + ")::input(matrix)::R"),
+      measureBufferSIN(NULL,
+                       "Kalman(" + name + ")::input(matrix)::y_buffer")
 
       ,
       statePredictedSIN(0, "Kalman(" + name + ")::input(vector)::x_pred"),
       observationPredictedSIN(0, "Kalman(" + name + ")::input(vector)::y_pred"),
       varianceUpdateSOUT("Kalman(" + name + ")::output(vector)::P"),
       stateUpdateSOUT("Kalman(" + name + ")::output(vector)::x_est"),
-      stateEstimation_(), stateVariance_() {
+      updateMode_(UPDATE_STANDARD), measureProcessing_(PROCESS_BATCH),
+      sequential_(false), stateEstimation_(), stateVariance_() {
   sotDEBUGIN(15);
   varianceUpdateSOUT.setFunction(
       boost::bind(&Kalman::computeVarianceUpdate, this, _1, _2));
@@ -45,7 +49,8 @@ Kalman::Kalman(const std::string &name)
 
   signalRegistration(measureSIN << observationPredictedSIN << modelTransitionSIN
                                 << modelMeasureSIN << noiseTransitionSIN
-                                << noiseMeasureSIN << statePredictedSIN
+                                << noiseMeasureSIN << measureBufferSIN
+                                << statePredictedSIN
                                 << stateUpdateSOUT << varianceUpdateSOUT);
 
   std::string docstring = "  Set initial state estimation\n"
@@ -63,9 +68,285 @@ Kalman::Kalman(const std::string &name)
   addCommand(
       "setInitialVariance",
       new Setter<Kalman, Matrix>(*this, &Kalman::setStateVariance, docstring));
+
+  docstring = "  Set the algorithm used to update the variance\n"
+              "\n"
+              "  input:\n"
+              "    - a string: standard, joseph or squareRoot\n";
+  addCommand("setUpdateMode",
+             command::makeCommandVoid1(*this, &Kalman::setUpdateMode,
+                                       docstring));
+  docstring = "  Get the algorithm used to update the variance\n";
+  addCommand("getUpdateMode",
+             command::makeCommandReturnType0(*this, &Kalman::getUpdateMode,
+                                             docstring));
+
+  docstring = "  Set how the components of the measure are processed\n"
+              "\n"
+              "  input:\n"
+              "    - a string: batch, sequential or auto\n";
+  addCommand("setMeasureProcessing",
+             command::makeCommandVoid1(*this, &Kalman::setMeasureProcessing,
+                                       docstring));
+  docstring = "  Get how the components of the measure are processed\n";
+  addCommand("getMeasureProcessing",
+             command::makeCommandReturnType0(
+                 *this, &Kalman::getMeasureProcessing, docstring));
   sotDEBUGOUT(15);
 }
 
+void Kalman::setStateVariance(const Matrix &P0) {
+  stateVariance_ = P0;
+  if (updateMode_ == UPDATE_SQUARE_ROOT)
+    squareRootOf(stateVariance_, stateVarianceSqrt_);
+  varianceUpdateSOUT.recompute(0);
+}
+
+void Kalman::setUpdateMode(const std::string &mode) {
+  if (mode == "standard")
+    updateMode_ = UPDATE_STANDARD;
+  else if (mode == "joseph")
+    updateMode_ = UPDATE_JOSEPH;
+  else if (mode == "squareRoot") {
+    updateMode_ = UPDATE_SQUARE_ROOT;
+    squareRootOf(stateVariance_, stateVarianceSqrt_);
+  } else
+    throw ExceptionTools(ExceptionTools::GENERIC,
+                         "Unknown Kalman update mode " + mode +
+                             ", expected standard, joseph or squareRoot.");
+}
+
+std::string Kalman::getUpdateMode() const {
+  switch (updateMode_) {
+  case UPDATE_JOSEPH:
+    return "joseph";
+  case UPDATE_SQUARE_ROOT:
+    return "squareRoot";
+  default:
+    return "standard";
+  }
+}
+
+void Kalman::setMeasureProcessing(const std::string &processing) {
+  if (processing == "batch")
+    measureProcessing_ = PROCESS_BATCH;
+  else if (processing == "sequential")
+    measureProcessing_ = PROCESS_SEQUENTIAL;
+  else if (processing == "auto")
+    measureProcessing_ = PROCESS_AUTO;
+  else
+    throw ExceptionTools(ExceptionTools::GENERIC,
+                         "Unknown Kalman measure processing " + processing +
+                             ", expected batch, sequential or auto.");
+}
+
+std::string Kalman::getMeasureProcessing() const {
+  switch (measureProcessing_) {
+  case PROCESS_SEQUENTIAL:
+    return "sequential";
+  case PROCESS_AUTO:
+    return "auto";
+  default:
+    return "batch";
+  }
+}
+
+void Kalman::squareRootOf(const Matrix &M, Matrix &sqrtM) {
+  // M = P^T L D L^T P, hence sqrtM = P^T L D^{1/2}. LDLT is used rather than
+  // LLT since noise variances are often only semi-definite.
+  ldlt_.compute(M);
+  sqrtWork_ = ldlt_.matrixL();
+  sqrtWork_ *= ldlt_.vectorD().cwiseMax(0.).cwiseSqrt().asDiagonal();
+  sqrtM.noalias() = ldlt_.transpositionsP().transpose() * sqrtWork_;
+}
+
+// The noise variances are usually constant: their decomposition is only
+// computed when they change.
+void Kalman::cachedSquareRootOf(const Matrix &M, Matrix &lastM,
+                                Matrix &sqrtM) {
+  if (M.rows() == lastM.rows() && M.cols() == lastM.cols() && M == lastM)
+    return;
+  squareRootOf(M, sqrtM);
+  lastM = M;
+}
+
+// Compute K = P H^T S^{-1} from H P without inverting S. Since P and S are
+// symmetric, K^T = S^{-1} (H P).
+void Kalman::computeGain(const Matrix &H, const Matrix &R) {
+  HP_.noalias() = H * Pk_k_1_;
+  S_ = R;
+  S_.noalias() += HP_ * H.transpose();
+
+  IKHP_ = HP_;
+  lltS_.compute(S_);
+  if (lltS_.info() == Eigen::Success) {
+    lltS_.solveInPlace(IKHP_);
+  } else {
+    ldltS_.compute(S_);
+    if (ldltS_.info() != Eigen::Success)
+      throw ExceptionTools(ExceptionTools::KALMAN_NOT_INVERTIBLE,
+                           "Innovation covariance is not invertible.");
+    ldltS_.solveInPlace(IKHP_);
+  }
+  K_ = IKHP_.transpose();
+}
+
+//   P   = P      - K  H  P
+//    k|k   k|k-1    k  k  k|k-1
+void Kalman::updateVarianceStandard(const Matrix &, Matrix &Pk_k) {
+  Pk_k = Pk_k_1_;
+  Pk_k.noalias() -= K_ * HP_;
+}
+
+//   P   = (I - K  H ) P      (I - K  H )^T + K  R K^T
+//    k|k        k  k   k|k-1        k  k      k    k
+void Kalman::updateVarianceJoseph(const Matrix &H, const Matrix &R,
+                                  Matrix &Pk_k) {
+  const Matrix::Index n = Pk_k_1_.rows();
+  IKH_.setIdentity(n, n);
+  IKH_.noalias() -= K_ * H;
+  IKHP_.noalias() = IKH_ * Pk_k_1_;
+  Pk_k.noalias() = IKHP_ * IKH_.transpose();
+  KR_.noalias() = K_ * R;
+  Pk_k.noalias() += KR_ * K_.transpose();
+}
+
+// Square root covariance filter. With P = L L^T, Q = Lq Lq^T, R = Lr Lr^T,
+//
+// prediction: [F L  Lq] T = [L      0]
+//                             k|k-1
+//
+// update:     [Lr  H L     ] T = [S^{1/2}  0   ]
+//             [0   L       ]     [K'       L   ]
+//                   k|k-1                   k|k
+//
+// where T are orthogonal matrices given by QR factorizations of the
+// transposed arrays, and K = K' S^{-1/2}.
+void Kalman::predictVariance(const Matrix &F, const Matrix &Q) {
+  const Matrix::Index n = F.rows();
+  if (updateMode_ != UPDATE_SQUARE_ROOT) {
+    FP_.noalias() = F * stateVariance_;
+    Pk_k_1_ = Q;
+    Pk_k_1_.noalias() += FP_ * F.transpose();
+    return;
+  }
+  if (stateVarianceSqrt_.rows() != n)
+    squareRootOf(stateVariance_, stateVarianceSqrt_);
+  cachedSquareRootOf(Q, lastQ_, sqrtQ_);
+
+  preArrayPrediction_.resize(2 * n, n);
+  preArrayPrediction_.topRows(n).noalias() =
+      stateVarianceSqrt_.transpose() * F.transpose();
+  preArrayPrediction_.bottomRows(n) = sqrtQ_.transpose();
+  qrPrediction_.compute(preArrayPrediction_);
+  stateVarianceSqrt_ =
+      qrPrediction_.matrixQR().topRows(n).triangularView<Eigen::Upper>();
+  stateVarianceSqrt_.transposeInPlace();
+  Pk_k_1_.noalias() = stateVarianceSqrt_ * stateVarianceSqrt_.transpose();
+}
+
+void Kalman::updateVarianceSquareRoot(const Matrix &H, const Matrix &R,
+                                      Matrix &Pk_k) {
+  const Matrix::Index n = H.cols();
+  const Matrix::Index m = H.rows();
+  cachedSquareRootOf(R, lastR_, sqrtR_);
+
+  preArrayUpdate_.resize(m + n, m + n);
+  preArrayUpdate_.topLeftCorner(m, m) = sqrtR_.transpose();
+  preArrayUpdate_.topRightCorner(m, n).setZero();
+  preArrayUpdate_.bottomLeftCorner(n, m).noalias() =
+      stateVarianceSqrt_.transpose() * H.transpose();
+  preArrayUpdate_.bottomRightCorner(n, n) = stateVarianceSqrt_.transpose();
+  qrUpdate_.compute(preArrayUpdate_);
+  const Matrix &postArray = qrUpdate_.matrixQR();
+
+  stateVarianceSqrt_ =
+      postArray.bottomRightCorner(n, n).triangularView<Eigen::Upper>();
+  stateVarianceSqrt_.transposeInPlace();
+  S_ = postArray.topLeftCorner(m, m).triangularView<Eigen::Upper>();
+  K_ = postArray.topRightCorner(m, n).transpose();
+  // K S^{1/2} = K', with S^{1/2} the transpose of the upper triangular S_.
+  S_.transpose().triangularView<Eigen::Lower>().solveInPlace<Eigen::OnTheRight>(
+      K_);
+
+  // Keep the innovation covariance available.
+  HP_.noalias() = S_.transpose() * S_;
+  S_ = HP_;
+  Pk_k.noalias() = stateVarianceSqrt_ * stateVarianceSqrt_.transpose();
+}
+
+bool Kalman::isSequential(const Matrix &R) const {
+  switch (measureProcessing_) {
+  case PROCESS_SEQUENTIAL:
+    return true;
+  case PROCESS_AUTO:
+    for (Matrix::Index j = 0; j < R.cols(); ++j)
+      for (Matrix::Index i = 0; i < R.rows(); ++i)
+        if (i != j && R(i, j) != 0.)
+          return false;
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Process the m scalar measurements of each of the nbMeasures measurement
+// vectors one after the other. With h the i-th row of H and r = R(i,i),
+//
+//   s = h P h^T + r,   k = P h^T / s,   P = P - k h P
+//
+// Column c = j m + i of K_ stores the gain of the c-th scalar update. In
+// square root mode, P = L L^T is updated by Potter's algorithm:
+//
+//   phi = L^T h^T,  a = 1 / (phi^T phi + r),  L = L - a g L phi phi^T
+//
+// with g = 1 / (1 + sqrt (a r)).
+void Kalman::updateVarianceSequential(const Matrix &H, const Matrix &R,
+                                      const Matrix::Index nbMeasures,
+                                      Matrix &Pk_k) {
+  const Matrix::Index n = H.cols();
+  const Matrix::Index m = H.rows();
+  K_.resize(n, m * nbMeasures);
+  if (updateMode_ != UPDATE_SQUARE_ROOT)
+    Pk_k = Pk_k_1_;
+
+  for (Matrix::Index j = 0; j < nbMeasures; ++j) {
+    for (Matrix::Index i = 0; i < m; ++i) {
+      const double r = R(i, i);
+      Eigen::Block<Matrix, Eigen::Dynamic, 1, true> k = K_.col(j * m + i);
+      if (updateMode_ == UPDATE_SQUARE_ROOT) {
+        phi_.noalias() = stateVarianceSqrt_.transpose() * H.row(i).transpose();
+        Ph_.noalias() = stateVarianceSqrt_ * phi_;
+        const double s = phi_.squaredNorm() + r;
+        if (r < 0. || s <= 0.)
+          throw ExceptionTools(ExceptionTools::KALMAN_NOT_INVERTIBLE,
+                               "Innovation variance is not positive.");
+        const double a = 1. / s;
+        const double g = 1. / (1. + std::sqrt(a * r));
+        k = a * Ph_;
+        stateVarianceSqrt_.noalias() -= (a * g) * Ph_ * phi_.transpose();
+        continue;
+      }
+      Ph_.noalias() = Pk_k * H.row(i).transpose();
+      const double s = H.row(i).dot(Ph_) + r;
+      if (s <= 0.)
+        throw ExceptionTools(ExceptionTools::KALMAN_NOT_INVERTIBLE,
+                             "Innovation variance is not positive.");
+      k = Ph_ / s;
+      if (updateMode_ == UPDATE_JOSEPH) {
+        // (I - k h) P (I - k h)^T + k r k^T
+        Pk_k.noalias() -= k * Ph_.transpose();
+        Pk_k.noalias() -= Ph_ * k.transpose();
+        Pk_k.noalias() += s * k * k.transpose();
+      } else {
+        Pk_k.noalias() -= k * Ph_.transpose();
+      }
+    }
+  }
+  if (updateMode_ == UPDATE_SQUARE_ROOT)
+    Pk_k.noalias() = stateVarianceSqrt_ * stateVarianceSqrt_.transpose();
+}
+
 Matrix &Kalman::computeVarianceUpdate(Matrix &Pk_k, const int &time) {
   sotDEBUGIN(15);
   if (time == 0) {
@@ -74,32 +355,44 @@ Matrix &Kalman::computeVarianceUpdate(Matrix &Pk_k, const int &time) {
     // Set dependency to input signals for latter computations
     varianceUpdateSOUT.addDependency(noiseTransitionSIN);
     varianceUpdateSOUT.addDependency(modelTransitionSIN);
+    varianceUpdateSOUT.addDependency(measureBufferSIN);
   } else {
 
     const Matrix &Q = noiseTransitionSIN(time);
     const Matrix &R = noiseMeasureSIN(time);
     const Matrix &F = modelTransitionSIN(time);
     const Matrix &H = modelMeasureSIN(time);
-    const Matrix &Pk_1_k_1 = stateVariance_;
+    const Matrix::Index nbMeasures =
+        measureBufferSIN.isPlugged() ? measureBufferSIN(time).cols() : 1;
 
     sotDEBUG(15) << "Q=" << Q << std::endl;
     sotDEBUG(15) << "R=" << R << std::endl;
     sotDEBUG(15) << "F=" << F << std::endl;
     sotDEBUG(15) << "H=" << H << std::endl;
-    sotDEBUG(15) << "Pk_1_k_1=" << Pk_1_k_1 << std::endl;
+    sotDEBUG(15) << "Pk_1_k_1=" << stateVariance_ << std::endl;
 
-    FP_ = F * Pk_1_k_1;
-    Pk_k_1_ = FP_ * F.transpose();
-    Pk_k_1_ += Q;
+    predictVariance(F, Q);
 
-    sotDEBUG(15) << "F " << std::endl << F << std::endl;
-    sotDEBUG(15) << "P_{k-1|k-1} " << std::endl << Pk_1_k_1 << std::endl;
-    sotDEBUG(15) << "F^T " << std::endl << F.transpose() << std::endl;
     sotDEBUG(15) << "P_{k|k-1} " << std::endl << Pk_k_1_ << std::endl;
 
-    S_ = H * Pk_k_1_ * H.transpose() + R;
-    K_ = Pk_k_1_ * H.transpose() * S_.inverse();
-    Pk_k = Pk_k_1_ - K_ * H * Pk_k_1_;
+    sequential_ = isSequential(R);
+    if (sequential_) {
+      updateVarianceSequential(H, R, nbMeasures, Pk_k);
+    } else {
+      if (nbMeasures != 1)
+        throw ExceptionTools(ExceptionTools::KALMAN_SIZE,
+                             "Buffered measurements require a sequential "
+                             "processing of the measurements.");
+      if (updateMode_ == UPDATE_SQUARE_ROOT) {
+        updateVarianceSquareRoot(H, R, Pk_k);
+      } else {
+        computeGain(H, R);
+        if (updateMode_ == UPDATE_JOSEPH)
+          updateVarianceJoseph(H, R, Pk_k);
+        else
+          updateVarianceStandard(H, Pk_k);
+      }
+    }
 
     sotDEBUG(15) << "S_{k} " << std::endl << S_ << std::endl;
     sotDEBUG(15) << "K_{k} " << std::endl << K_ << std::endl;
@@ -138,6 +431,7 @@ Vector &Kalman::computeStateUpdate(Vector &x_est, const int &time) {
     x_est = stateEstimation_;
     // Set dependency to input signals for latter computations
     stateUpdateSOUT.addDependency(measureSIN);
+    stateUpdateSOUT.addDependency(measureBufferSIN);
     stateUpdateSOUT.addDependency(observationPredictedSIN);
     stateUpdateSOUT.addDependency(modelMeasureSIN);
     stateUpdateSOUT.addDependency(noiseTransitionSIN);
@@ -148,18 +442,38 @@ Vector &Kalman::computeStateUpdate(Vector &x_est, const int &time) {
     varianceUpdateSOUT.recompute(time);
     const Vector &x_pred = statePredictedSIN(time);
     const Vector &y_pred = observationPredictedSIN(time);
-    const Vector &y = measureSIN(time);
 
     sotDEBUG(25) << "K_{k} = " << std::endl << K_ << std::endl;
-    sotDEBUG(25) << "y = " << y << std::endl;
     sotDEBUG(25) << "h (\\hat{x}_{k|k-1}) = " << y_pred << std::endl;
-    sotDEBUG(25) << "y = " << y << std::endl;
-
-    // Innovation: z_ = y - Hx
-    z_ = y - y_pred;
-    // x_est = x_pred + (K*(y-(H*x_pred)));
-    x_est = x_pred + K_ * z_;
 
+    if (!sequential_) {
+      const Vector &y = measureSIN(time);
+      sotDEBUG(25) << "y = " << y << std::endl;
+      // Innovation: z_ = y - Hx
+      z_ = y - y_pred;
+      // x_est = x_pred + (K*(y-(H*x_pred)));
+      x_est = x_pred;
+      x_est.noalias() += K_ * z_;
+    } else {
+      // Each scalar innovation accounts for the corrections already applied
+      //   z = y  - h (x     ) - H  (x - x     )
+      //    i   i       k|k-1     i       k|k-1
+      const Matrix &H = modelMeasureSIN(time);
+      const bool buffered = measureBufferSIN.isPlugged();
+      const Matrix::Index m = H.rows();
+      const Matrix::Index nbMeasures = K_.cols() / m;
+      x_est = x_pred;
+      for (Matrix::Index j = 0; j < nbMeasures; ++j) {
+        if (buffered)
+          z_ = measureBufferSIN(time).col(j) - y_pred;
+        else
+          z_ = measureSIN(time) - y_pred;
+        sotDEBUG(25) << "y = " << z_ + y_pred << std::endl;
+        for (Matrix::Index i = 0; i < m; ++i)
+          x_est += K_.col(j * m + i) *
+                   (z_(i) - H.row(i).dot(x_est - x_pred));
+      }
+    }
     sotDEBUG(25) << "z_{k} = " << z_ << std::endl;
     sotDEBUG(25) << "x_{k|k} = " << x_est << std::endl;
 
@@ -17,8 +17,24 @@
 //  sotJTE__INIT sotJTE_initiator;
 // #endif //#ifdef VP_DEBUG
 
+#include <sot/core/exception-tools.hh>
 #include <sot/core/trajectory.hh>
 
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdint.h>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif /*WIN32*/
+
 /************************/
 /* JointTrajectoryPoint */
 /************************/
@@ -229,7 +245,7 @@ bool RulesJointTrajectory::parse_point(std::string &trajectory,
   if (!parse_seq(sub_text2, sub_text1, aJTP.efforts_))
     return false;
 
-  TrajectoryToFill_.points_.push_back(aJTP);
+  TrajectoryToFill_.addPoint(aJTP);
   return true;
 }
 
@@ -286,24 +302,543 @@ void RulesJointTrajectory::parse_string(std::string &atext) {
   parse_points(sub_text1, sub_text2);
 }
 
-Trajectory::Trajectory(void) {}
+/************************/
+/* TrajectoryTextParser */
+/************************/
+
+namespace {
+/// Positions, velocities, accelerations and efforts.
+const std::size_t nbQuantities = 4;
+
+/// Single pass parser of the textual representation of a trajectory. It
+/// never backtracks and appends the values of the points to one buffer per
+/// quantity, which are then copied in the matrices of the trajectory.
+/// Blanks and quotes are ignored between the tokens.
+class TrajectoryTextParser {
+public:
+  explicit TrajectoryTextParser(const std::string &text)
+      : begin_(text.c_str()), cur_(begin_), end_(begin_ + text.size()) {
+    std::fill(sizes_, sizes_ + nbQuantities, 0);
+  }
+
+  void parse(Trajectory &traj) {
+    // The whole text may be enclosed in parentheses.
+    expect('(');
+    const bool enclosed = accept('(');
+
+    // Header: (seq,(secs,nsecs),frame_id)
+    traj.header_.seq_ = static_cast<unsigned int>(readUnsigned());
+    expect(',');
+    expect('(');
+    traj.header_.stamp_.secs_ = static_cast<unsigned long>(readDouble());
+    expect(',');
+    traj.header_.stamp_.nsecs_ = static_cast<unsigned long>(readDouble());
+    expect(')');
+    expect(',');
+    readName(traj.header_.frame_id_, true);
+    expect(')');
+    expect(',');
+
+    // Joint names: (joint_1,...,joint_n)
+    std::size_t nbJoints = 0;
+    if (beginList()) {
+      do {
+        if (nbJoints == traj.joint_names_.size())
+          traj.joint_names_.push_back(std::string());
+        readName(traj.joint_names_[nbJoints++], false);
+      } while (nextItem());
+    }
+    traj.joint_names_.resize(nbJoints);
+    expect(',');
+
+    // Points: (((positions),(velocities),(accelerations),(efforts)),...)
+    std::size_t nbPoints = 0;
+    if (beginList()) {
+      do {
+        expect('(');
+        for (std::size_t q = 0; q < nbQuantities; ++q) {
+          if (q != 0)
+            expect(',');
+          readValues(q, nbPoints);
+        }
+        times_.push_back(0.);
+        if (nextItem()) {
+          times_.back() = readDouble();
+          if (nextItem())
+            fail("expected the end of the point");
+        }
+        ++nbPoints;
+      } while (nextItem());
+    }
+    for (std::size_t q = 0; q < nbQuantities; ++q) {
+      traj.quantity(q) = Eigen::Map<const Matrix>(
+          values_[q].empty() ? NULL : &values_[q][0], sizes_[q],
+          static_cast<Eigen::Index>(nbPoints));
+    }
+    traj.times_from_start_ =
+        Eigen::Map<const Vector>(times_.empty() ? NULL : &times_[0],
+                                 static_cast<Eigen::Index>(nbPoints));
+
+    if (enclosed)
+      expect(')');
+    skipBlanks();
+    if (cur_ != end_)
+      fail("unexpected text after the list of points");
+  }
+
+private:
+  const char *begin_, *cur_, *end_;
+  /// Values of each quantity, point after point.
+  std::vector<double> values_[nbQuantities];
+  /// Number of values of each quantity per point.
+  Eigen::Index sizes_[nbQuantities];
+  std::vector<double> times_;
+
+  void fail(const std::string &msg) {
+    throw ExceptionTools(ExceptionTools::GENERIC,
+                         "Malformed trajectory: " + msg, " (at character %d).",
+                         static_cast<int>(cur_ - begin_));
+  }
+
+  void skipBlanks() {
+    while (cur_ != end_ &&
+           (std::isspace(static_cast<unsigned char>(*cur_)) || *cur_ == '\'' ||
+            *cur_ == '"'))
+      ++cur_;
+  }
+
+  bool accept(const char c) {
+    skipBlanks();
+    if (cur_ != end_ && *cur_ == c) {
+      ++cur_;
+      return true;
+    }
+    return false;
+  }
+
+  void expect(const char c) {
+    if (!accept(c))
+      fail(std::string("expected '") + c + "'");
+  }
+
+  /// Read the opening parenthesis of a list. Return false if the list is
+  /// empty, in which case the closing parenthesis is read as well.
+  bool beginList() {
+    expect('(');
+    return !accept(')');
+  }
+
+  /// Read the separator after an item of a list. Return false at the end of
+  /// the list, a trailing comma being allowed.
+  bool nextItem() {
+    if (accept(','))
+      return !accept(')');
+    expect(')');
+    return false;
+  }
+
+  double readDouble() {
+    skipBlanks();
+    char *next;
+    const double value = std::strtod(cur_, &next);
+    if (next == cur_ || next > end_)
+      fail("expected a number");
+    cur_ = next;
+    return value;
+  }
+
+  unsigned long readUnsigned() {
+    skipBlanks();
+    char *next;
+    const unsigned long value = std::strtoul(cur_, &next, 10);
+    if (next == cur_ || next > end_)
+      fail("expected an integer");
+    cur_ = next;
+    return value;
+  }
+
+  void readName(std::string &name, const bool allowEmpty) {
+    skipBlanks();
+    const char *first = cur_;
+    while (cur_ != end_ && std::strchr("(),'\" \t\r\n", *cur_) == NULL)
+      ++cur_;
+    if (cur_ == first && !allowEmpty)
+      fail("expected a name");
+    name.assign(first, cur_);
+  }
+
+  /// Read the values of quantity q of a point and check that there are as
+  /// many as for the previous points.
+  void readValues(const std::size_t q, const std::size_t nbPoints) {
+    std::vector<double> &values = values_[q];
+    const std::size_t first = values.size();
+    if (beginList()) {
+      do
+        values.push_back(readDouble());
+      while (nextItem());
+    }
+    const Eigen::Index n = static_cast<Eigen::Index>(values.size() - first);
+    if (nbPoints == 0)
+      sizes_[q] = n;
+    else if (n != sizes_[q])
+      fail("the points do not have the same number of values");
+  }
+};
+
+/***********************/
+/* Binary format       */
+/***********************/
+
+const char binaryMagic[8] = {'S', 'O', 'T', 'T', 'R', 'A', 'J', '\0'};
+const uint32_t binaryByteOrder = 0x01020304;
+const uint32_t binaryVersion = 3;
+
+struct BinaryHeader {
+  char magic[8];
+  uint32_t byteOrder;
+  uint32_t version;
+  uint32_t seq;
+  uint32_t nbJoints;
+  uint64_t secs;
+  uint64_t nsecs;
+  uint32_t nbPoints;
+  /// Size of the block of names, padding included.
+  uint32_t namesSize;
+  /// Number of rows of each quantity, 0 if it is not given.
+  uint32_t sizes[nbQuantities];
+};
+static_assert(sizeof(BinaryHeader) == 64, "Unexpected size of BinaryHeader");
+
+const char *quantityNames[nbQuantities] = {"Positions", "Velocities",
+                                           "Accelerations", "Effort"};
+
+void binaryError(const std::string &msg) {
+  throw ExceptionTools(ExceptionTools::GENERIC,
+                       "Invalid binary trajectory: " + msg);
+}
+} // namespace
+
+Trajectory::Trajectory(void) : time_from_start_(0.) {}
 
 Trajectory::Trajectory(const Trajectory &copy) {
   header_ = copy.header_;
   time_from_start_ = copy.time_from_start_;
-  points_ = copy.points_;
+  positions_ = copy.positions_;
+  velocities_ = copy.velocities_;
+  accelerations_ = copy.accelerations_;
+  efforts_ = copy.efforts_;
+  times_from_start_ = copy.times_from_start_;
 }
 
 Trajectory::~Trajectory(void) {}
 
-int Trajectory::deserialize(std::istringstream &is) {
-  std::string aStr = is.str();
-  RulesJointTrajectory aRJT(*this);
-  aRJT.parse_string(aStr);
+Matrix &Trajectory::quantity(const std::size_t i) {
+  switch (i) {
+  case 0:
+    return positions_;
+  case 1:
+    return velocities_;
+  case 2:
+    return accelerations_;
+  default:
+    return efforts_;
+  }
+}
+
+const Matrix &Trajectory::quantity(const std::size_t i) const {
+  return const_cast<Trajectory *>(this)->quantity(i);
+}
+
+void Trajectory::addPoint(const JointTrajectoryPoint &point) {
+  const Eigen::Index n = positions_.cols();
+  const std::vector<double> *values[nbQuantities] = {
+      &point.positions_, &point.velocities_, &point.accelerations_,
+      &point.efforts_};
+  for (std::size_t q = 0; q < nbQuantities; ++q) {
+    const Eigen::Index size = static_cast<Eigen::Index>(values[q]->size());
+    if (n != 0 && size != quantity(q).rows())
+      throw ExceptionTools(ExceptionTools::GENERIC,
+                           "The point does not have the same number of " +
+                               std::string(quantityNames[q]) +
+                               " as the previous points.");
+  }
+  for (std::size_t q = 0; q < nbQuantities; ++q) {
+    Matrix &m = quantity(q);
+    const Eigen::Index size = static_cast<Eigen::Index>(values[q]->size());
+    m.conservativeResize(size, n + 1);
+    if (size != 0)
+      m.col(n) = Eigen::Map<const Vector>(&(*values[q])[0], size);
+  }
+  times_from_start_.conservativeResize(n + 1);
+  times_from_start_(n) = point.time_from_start_;
+}
+
+void Trajectory::clearPoints() {
+  for (std::size_t q = 0; q < nbQuantities; ++q)
+    quantity(q).resize(0, 0);
+  times_from_start_.resize(0);
+}
+
+void Trajectory::swap(Trajectory &other) {
+  joint_names_.swap(other.joint_names_);
+  std::swap(header_, other.header_);
+  std::swap(time_from_start_, other.time_from_start_);
+  for (std::size_t q = 0; q < nbQuantities; ++q)
+    quantity(q).swap(other.quantity(q));
+  times_from_start_.swap(other.times_from_start_);
+}
+
+std::size_t Trajectory::findSegment(const double t,
+                                    const std::size_t hint) const {
+  if (nbPoints() < 2)
+    return 0;
+  const std::size_t last = nbPoints() - 2;
+  const double *times = times_from_start_.data();
+  if (hint <= last && times[hint] <= t) {
+    std::size_t k = hint;
+    while (k < last && times[k + 1] <= t)
+      ++k;
+    return k;
+  }
+  const std::size_t k = static_cast<std::size_t>(
+      std::upper_bound(times, times + last + 1, t) - times);
+  return k == 0 ? 0 : k - 1;
+}
+
+void Trajectory::interpolatePositions(const double t,
+                                      const Interpolation interpolation,
+                                      std::size_t &segment,
+                                      Vector &positions) const {
+  const std::size_t n = nbPoints();
+  if (n == 0)
+    throw ExceptionTools(ExceptionTools::GENERIC,
+                         "Cannot interpolate an empty trajectory.");
+  if (n == 1 || t <= times_from_start_(0)) {
+    segment = 0;
+    positions = positions_.col(0);
+    return;
+  }
+  if (t >= times_from_start_(n - 1)) {
+    segment = n - 2;
+    positions = positions_.col(n - 1);
+    return;
+  }
 
+  segment = findSegment(t, segment);
+  const Eigen::Index k = static_cast<Eigen::Index>(segment);
+  const double h = times_from_start_(k + 1) - times_from_start_(k);
+  const double s = (t - times_from_start_(k)) / h;
+  const Eigen::Index nq = positions_.rows();
+
+  Interpolation order = interpolation;
+  if (order == INTERPOLATION_QUINTIC && accelerations_.rows() != nq)
+    order = INTERPOLATION_CUBIC;
+  if (order == INTERPOLATION_CUBIC && velocities_.rows() != nq)
+    order = INTERPOLATION_LINEAR;
+
+  Matrix::ConstColXpr p0 = positions_.col(k), p1 = positions_.col(k + 1);
+  switch (order) {
+  case INTERPOLATION_LINEAR:
+    positions = p0 + s * (p1 - p0);
+    break;
+  case INTERPOLATION_CUBIC: {
+    // Hermite basis on [0, 1], the velocities being scaled by h.
+    const double s2 = s * s, s3 = s2 * s;
+    positions = (2 * s3 - 3 * s2 + 1) * p0 + (-2 * s3 + 3 * s2) * p1 +
+                ((s3 - 2 * s2 + s) * h) * velocities_.col(k) +
+                ((s3 - s2) * h) * velocities_.col(k + 1);
+    break;
+  }
+  case INTERPOLATION_QUINTIC: {
+    // p(s) = p0 + V0 s + A0 s^2 / 2 + c3 s^3 + c4 s^4 + c5 s^5 with the
+    // velocities V and accelerations A scaled by h and h^2.
+    const double s2 = s * s, s3 = s2 * s, s4 = s3 * s, s5 = s4 * s;
+    const double h2 = h * h;
+    positions = (1 - 10 * s3 + 15 * s4 - 6 * s5) * p0 +
+                (10 * s3 - 15 * s4 + 6 * s5) * p1 +
+                ((s - 6 * s3 + 8 * s4 - 3 * s5) * h) * velocities_.col(k) +
+                ((-4 * s3 + 7 * s4 - 3 * s5) * h) * velocities_.col(k + 1) +
+                ((0.5 * s2 - 1.5 * s3 + 1.5 * s4 - 0.5 * s5) * h2) *
+                    accelerations_.col(k) +
+                ((0.5 * s3 - s4 + 0.5 * s5) * h2) * accelerations_.col(k + 1);
+    break;
+  }
+  }
+}
+
+int Trajectory::deserialize(const std::string &text) {
+  TrajectoryTextParser(text).parse(*this);
   return 0;
 }
 
+int Trajectory::deserialize(std::istringstream &is) {
+  return deserialize(is.str());
+}
+
+void Trajectory::serializeBinary(std::ostream &os) const {
+  const std::size_t nbJoints = joint_names_.size();
+
+  BinaryHeader h;
+  std::memset(&h, 0, sizeof(h));
+  std::memcpy(h.magic, binaryMagic, sizeof(h.magic));
+  h.byteOrder = binaryByteOrder;
+  h.version = binaryVersion;
+  h.seq = header_.seq_;
+  h.nbJoints = static_cast<uint32_t>(nbJoints);
+  h.secs = header_.stamp_.secs_;
+  h.nsecs = header_.stamp_.nsecs_;
+  h.nbPoints = static_cast<uint32_t>(nbPoints());
+  for (std::size_t q = 0; q < nbQuantities; ++q)
+    h.sizes[q] = static_cast<uint32_t>(quantity(q).rows());
+
+  std::string names(header_.frame_id_);
+  names.push_back('\0');
+  for (std::size_t j = 0; j < nbJoints; ++j) {
+    names += joint_names_[j];
+    names.push_back('\0');
+  }
+  names.resize((names.size() + 7) / 8 * 8, '\0');
+  h.namesSize = static_cast<uint32_t>(names.size());
+
+  os.write(reinterpret_cast<const char *>(&h), sizeof(h));
+  os.write(names.data(), static_cast<std::streamsize>(names.size()));
+  for (std::size_t q = 0; q < nbQuantities; ++q) {
+    const Matrix &m = quantity(q);
+    os.write(reinterpret_cast<const char *>(m.data()),
+             static_cast<std::streamsize>(m.size() * sizeof(double)));
+  }
+  os.write(reinterpret_cast<const char *>(times_from_start_.data()),
+           static_cast<std::streamsize>(nbPoints() * sizeof(double)));
+}
+
+void Trajectory::deserializeBinary(const char *data, const std::size_t size) {
+  BinaryHeader h;
+  if (size < sizeof(h))
+    binaryError("the header is truncated.");
+  std::memcpy(&h, data, sizeof(h));
+  if (std::memcmp(h.magic, binaryMagic, sizeof(h.magic)) != 0)
+    binaryError("wrong magic string.");
+  if (h.byteOrder != binaryByteOrder)
+    binaryError("wrong byte order.");
+  if (h.version != binaryVersion)
+    binaryError("unsupported version.");
+
+  const std::size_t nbJoints = h.nbJoints, nbPoints = h.nbPoints;
+  if (h.sizes[0] != nbJoints)
+    binaryError("the number of positions does not match the joint names.");
+
+  // The sizes of the header are compared with the size of the data before
+  // being multiplied, so that their products cannot overflow.
+  const uint64_t valuesSize = uint64_t(size) - sizeof(h);
+  if (h.namesSize > valuesSize)
+    binaryError("the size of the data does not match the header.");
+  const uint64_t maxNbValues = (valuesSize - h.namesSize) / sizeof(double);
+  if (nbPoints > maxNbValues)
+    binaryError("the size of the data does not match the header.");
+  uint64_t nbValues = nbPoints;
+  for (std::size_t q = 0; q < nbQuantities; ++q) {
+    if (nbPoints != 0 && h.sizes[q] > (maxNbValues - nbValues) / nbPoints)
+      binaryError("the size of the data does not match the header.");
+    nbValues += uint64_t(h.sizes[q]) * nbPoints;
+  }
+  if (valuesSize != h.namesSize + nbValues * sizeof(double))
+    binaryError("the size of the data does not match the header.");
+
+  // Names
+  const char *names = data + sizeof(h), *namesEnd = names + h.namesSize;
+  const char *cur = names;
+  for (std::size_t j = 0; j <= nbJoints; ++j) {
+    const char *end =
+        static_cast<const char *>(std::memchr(cur, '\0', namesEnd - cur));
+    if (end == NULL)
+      binaryError("the block of names is truncated.");
+    if (j == 0)
+      header_.frame_id_.assign(cur, end);
+    else {
+      if (j > joint_names_.size())
+        joint_names_.push_back(std::string());
+      joint_names_[j - 1].assign(cur, end);
+    }
+    cur = end + 1;
+  }
+  joint_names_.resize(nbJoints);
+
+  header_.seq_ = h.seq;
+  header_.stamp_.secs_ = static_cast<unsigned long>(h.secs);
+  header_.stamp_.nsecs_ = static_cast<unsigned long>(h.nsecs);
+
+  // Values: one block per quantity.
+  const char *values = namesEnd;
+  for (std::size_t q = 0; q < nbQuantities; ++q) {
+    Matrix &m = quantity(q);
+    m.resize(static_cast<Eigen::Index>(h.sizes[q]),
+             static_cast<Eigen::Index>(nbPoints));
+    const std::size_t n = static_cast<std::size_t>(m.size()) * sizeof(double);
+    if (n != 0)
+      std::memcpy(m.data(), values, n);
+    values += n;
+  }
+  times_from_start_.resize(static_cast<Eigen::Index>(nbPoints));
+  if (nbPoints != 0)
+    std::memcpy(times_from_start_.data(), values, nbPoints * sizeof(double));
+}
+
+void Trajectory::saveBinaryFile(const std::string &filename) const {
+  std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary);
+  if (!file)
+    throw ExceptionTools(ExceptionTools::GENERIC,
+                         "Could not open file " + filename);
+  serializeBinary(file);
+}
+
+void Trajectory::loadBinaryFile(const std::string &filename) {
+#ifndef WIN32
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw ExceptionTools(ExceptionTools::GENERIC,
+                         "Could not open file " + filename);
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    binaryError("could not read file " + filename);
+  }
+  const std::size_t size = static_cast<std::size_t>(st.st_size);
+  void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    throw ExceptionTools(ExceptionTools::GENERIC,
+                         "Could not map file " + filename);
+  try {
+    deserializeBinary(static_cast<const char *>(data), size);
+  } catch (...) {
+    munmap(data, size);
+    throw;
+  }
+  munmap(data, size);
+#else  /*WIN32*/
+  std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!file)
+    throw ExceptionTools(ExceptionTools::GENERIC,
+                         "Could not open file " + filename);
+  std::vector<char> data((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+  if (data.empty())
+    binaryError("could not read file " + filename);
+  deserializeBinary(&data[0], data.size());
+#endif /*WIN32*/
+}
+
+void Trajectory::ConstPoint::display(std::ostream &os) const {
+  const Matrix::ConstColXpr *values[nbQuantities] = {
+      &positions_, &velocities_, &accelerations_, &efforts_};
+  for (std::size_t q = 0; q < nbQuantities; ++q) {
+    os << quantityNames[q] << std::endl << "---------" << std::endl;
+    for (Eigen::Index i = 0; i < values[q]->size(); ++i)
+      os << (*values[q])(i) << std::endl;
+  }
+  os << "Time from start: " << time_from_start_ << std::endl;
+}
+
 void Trajectory::display(std::ostream &os) const {
   unsigned int index = 0;
   os << "-- Trajectory --" << std::endl;
@@ -312,12 +847,9 @@ void Trajectory::display(std::ostream &os) const {
        it_joint_name != joint_names_.end(); it_joint_name++, index++)
     os << "Joint(" << index << ")=" << *(it_joint_name) << std::endl;
 
-  os << " Number of points: " << points_.size() << std::endl;
-  for (std::vector<JointTrajectoryPoint>::const_iterator it_point =
-           points_.begin();
-       it_point != points_.end(); it_point++) {
-    it_point->display(os);
-  }
+  os << " Number of points: " << nbPoints() << std::endl;
+  for (std::size_t i = 0; i < nbPoints(); ++i)
+    point(i).display(os);
 }
 
 } // namespace sot
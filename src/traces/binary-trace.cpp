@@ -0,0 +1,114 @@
+/*
+ * Copyright 2020,
+ * CNRS/AIST
+ *
+ */
+
+#include <dynamic-graph/exception-traces.h>
+#include <sot/core/binary-trace.hh>
+
+#include <cstring>
+
+namespace dynamicgraph {
+namespace sot {
+
+namespace {
+const char binaryMagic[8] = {'S', 'O', 'T', 'T', 'R', 'A', 'C', 'E'};
+const uint32_t binaryByteOrder = 0x01020304;
+const uint32_t binaryVersion = 1;
+
+struct BinaryHeader {
+  char magic[8];
+  uint32_t byteOrder;
+  uint32_t version;
+  uint32_t nbEntries;
+  /// Size of the block of names, padding included.
+  uint32_t namesSize;
+};
+static_assert(sizeof(BinaryHeader) == 24, "Unexpected size of BinaryHeader");
+
+void binaryError(const std::string &msg) {
+  throw ExceptionTraces(ExceptionTraces::GENERIC,
+                        "Invalid binary trace: " + msg);
+}
+} // namespace
+
+std::size_t BinaryTraceHeader::recordSize(void) const {
+  std::size_t size = 1;
+  for (std::size_t i = 0; i < entries.size(); ++i)
+    size += std::size_t(entries[i].rows) * entries[i].cols;
+  return size;
+}
+
+void BinaryTraceHeader::write(std::ostream &os) const {
+  std::string names;
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    names += entries[i].name;
+    names.push_back('\0');
+  }
+  names.resize((names.size() + 7) / 8 * 8, '\0');
+
+  BinaryHeader h;
+  std::memcpy(h.magic, binaryMagic, sizeof(h.magic));
+  h.byteOrder = binaryByteOrder;
+  h.version = binaryVersion;
+  h.nbEntries = static_cast<uint32_t>(entries.size());
+  h.namesSize = static_cast<uint32_t>(names.size());
+  os.write(reinterpret_cast<const char *>(&h), sizeof(h));
+
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    const uint32_t sizes[2] = {entries[i].rows, entries[i].cols};
+    os.write(reinterpret_cast<const char *>(sizes), sizeof(sizes));
+  }
+  os.write(names.data(), static_cast<std::streamsize>(names.size()));
+}
+
+bool BinaryTraceHeader::isBinaryTrace(const char *data,
+                                      const std::size_t size) {
+  return size >= sizeof(binaryMagic) &&
+         std::memcmp(data, binaryMagic, sizeof(binaryMagic)) == 0;
+}
+
+std::size_t BinaryTraceHeader::read(const char *data, const std::size_t size) {
+  BinaryHeader h;
+  if (size < sizeof(h))
+    binaryError("the header is truncated.");
+  std::memcpy(&h, data, sizeof(h));
+  if (std::memcmp(h.magic, binaryMagic, sizeof(h.magic)) != 0)
+    binaryError("wrong magic string.");
+  if (h.byteOrder != binaryByteOrder)
+    binaryError("wrong byte order.");
+  if (h.version != binaryVersion)
+    binaryError("unsupported version.");
+  if (h.namesSize % 8 != 0)
+    binaryError("the block of names is not padded.");
+
+  const uint64_t headerSize =
+      sizeof(h) + 2 * sizeof(uint32_t) * uint64_t(h.nbEntries) + h.namesSize;
+  if (uint64_t(size) < headerSize)
+    binaryError("the header is truncated.");
+
+  entries.resize(h.nbEntries);
+  const char *cur = data + sizeof(h);
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    uint32_t sizes[2];
+    std::memcpy(sizes, cur, sizeof(sizes));
+    entries[i].rows = sizes[0];
+    entries[i].cols = sizes[1];
+    cur += sizeof(sizes);
+  }
+
+  const char *namesEnd = cur + h.namesSize;
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    const char *end =
+        static_cast<const char *>(std::memchr(cur, '\0', namesEnd - cur));
+    if (end == NULL)
+      binaryError("the block of names is truncated.");
+    entries[i].name.assign(cur, end);
+    cur = end + 1;
+  }
+  return static_cast<std::size_t>(headerSize);
+}
+
+} /* namespace sot */
+} /* namespace dynamicgraph */
@@ -12,13 +12,27 @@
 /* --------------------------------------------------------------------- */
 
 /* SOT */
+#include <sot/core/binary-trace.hh>
 #include <sot/core/debug.hh>
 #include <sot/core/reader.hh>
 
 #include <boost/bind.hpp>
 #include <dynamic-graph/all-commands.h>
 #include <dynamic-graph/factory.h>
-#include <sstream>
+
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else /*WIN32*/
+#include <iterator>
+#endif /*WIN32*/
 
 using namespace dynamicgraph;
 using namespace dynamicgraph::sot;
@@ -26,6 +40,22 @@ using namespace std;
 
 DYNAMICGRAPH_FACTORY_ENTITY_PLUGIN(sotReader, "Reader");
 
+/// Whether the text from cur starts with a number as read by operator>>:
+/// a sign, digits and a decimal point, with at least one digit.
+static bool startsWithNumber(const char *cur, const char *end) {
+  if (cur != end && (*cur == '+' || *cur == '-'))
+    ++cur;
+  bool digits = false;
+  while (cur != end && std::isdigit(static_cast<unsigned char>(*cur))) {
+    ++cur;
+    digits = true;
+  }
+  if (cur != end && *cur == '.')
+    ++cur;
+  return digits ||
+         (cur != end && std::isdigit(static_cast<unsigned char>(*cur)));
+}
+
 /* --------------------------------------------------------------------- */
 /* --- CLASS ----------------------------------------------------------- */
 /* --------------------------------------------------------------------- */
@@ -36,7 +66,9 @@ sotReader::sotReader(const std::string n)
                  sotNOSIGNAL, "Reader(" + n + ")::vector"),
       matrixSOUT(boost::bind(&sotReader::getNextMatrix, this, _1, _2),
                  vectorSOUT, "Reader(" + n + ")::matrix"),
-      dataSet(), currentData(), iteratorSet(false), rows(0), cols(0) {
+      files(), currentFile(0), currentLine(NULL), iteratorSet(false),
+      record(NULL), recordWidth(0), rows(0), cols(0), ring(), ringHead(0),
+      ringTail(0), streamStop(false), playing(true), players(0) {
   signalRegistration(selectionSIN << vectorSOUT << matrixSOUT);
   selectionSIN = true;
   vectorSOUT.setNeedUpdateFromAllChildren(true);
@@ -44,6 +76,11 @@ sotReader::sotReader(const std::string n)
   initCommands();
 }
 
+sotReader::~sotReader(void) {
+  clear();
+  stopStreaming();
+}
+
 /* --------------------------------------------------------------------- */
 /* --------------------------------------------------------------------- */
 /* --------------------------------------------------------------------- */
@@ -51,84 +88,308 @@ sotReader::sotReader(const std::string n)
 void sotReader::load(const string &filename) {
   sotDEBUGIN(15);
 
-  std::ifstream datafile(filename.c_str());
-  const unsigned int SIZE = 1024;
-  char buffer[SIZE];
-  std::vector<double> newline;
-  while (datafile.good()) {
-    datafile.getline(buffer, SIZE);
-    const unsigned int gcount = (unsigned int)(datafile.gcount());
-    if (gcount >= SIZE) { /* TODO read error, line to long. */
+  File file;
+  file.data = NULL;
+  file.offset = 0;
+  file.width = 0;
+#ifndef WIN32
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw ExceptionTraces(ExceptionTraces::NOT_OPEN,
+                          "Could not open file " + filename);
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    throw ExceptionTraces(ExceptionTraces::NOT_OPEN,
+                          "Could not read file " + filename);
+  }
+  file.size = static_cast<std::size_t>(st.st_size);
+  if (file.size != 0) {
+    void *data = mmap(NULL, file.size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      throw ExceptionTraces(ExceptionTraces::NOT_OPEN,
+                            "Could not map file " + filename);
     }
-    std::istringstream iss(buffer);
-    newline.clear();
-    sotDEBUG(25) << "Get line = '" << buffer << "'" << std::endl;
-    while (1) {
-      double x;
-      iss >> x;
-      if (!iss.fail())
-        newline.push_back(x);
-      else
-        break;
-      sotDEBUG(45) << "New data = " << x << std::endl;
+    madvise(data, file.size, MADV_SEQUENTIAL);
+    file.data = static_cast<const char *>(data);
+  }
+  close(fd);
+#else  /*WIN32*/
+  std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!stream)
+    throw ExceptionTraces(ExceptionTraces::NOT_OPEN,
+                          "Could not open file " + filename);
+  std::vector<char> content((std::istreambuf_iterator<char>(stream)),
+                            std::istreambuf_iterator<char>());
+  file.size = content.size();
+  if (file.size != 0) {
+    char *data = new char[file.size];
+    std::memcpy(data, &content[0], file.size);
+    file.data = data;
+  }
+#endif /*WIN32*/
+
+  if (BinaryTraceHeader::isBinaryTrace(file.data, file.size)) {
+    BinaryTraceHeader header;
+    try {
+      file.offset = header.read(file.data, file.size);
+    } catch (...) {
+      release(file);
+      throw;
     }
-    if (newline.size() > 0)
-      dataSet.push_back(newline);
+    file.width = header.recordSize();
   }
 
+  // A binary trace without record is ignored as an empty file.
+  const std::size_t minimalSize =
+      file.width != 0 ? file.width * sizeof(double) : 1;
+  if (file.size - file.offset < minimalSize) {
+    release(file);
+  } else {
+    // The files are read while playing: it is stopped while one is added.
+    stopPlaying();
+    files.push_back(file);
+    startPlaying();
+  }
+  sotDEBUG(25) << "Mapped " << file.size << " bytes of " << filename
+               << std::endl;
+
   sotDEBUGOUT(15);
 }
 
 void sotReader::clear(void) {
   sotDEBUGIN(15);
 
-  dataSet.clear();
+  stopPlaying();
+  for (std::size_t i = 0; i < files.size(); ++i)
+    release(files[i]);
+  files.clear();
+  currentLine = NULL;
   iteratorSet = false;
+  ringHead = ringTail = 0;
+  startPlaying();
 
   sotDEBUGOUT(15);
 }
 
+void sotReader::release(const File &file) {
+  if (file.data == NULL)
+    return;
+#ifndef WIN32
+  munmap(const_cast<char *>(file.data), file.size);
+#else  /*WIN32*/
+  delete[] file.data;
+#endif /*WIN32*/
+}
+
 void sotReader::rewind(void) {
   sotDEBUGIN(15);
+  stopPlaying();
   iteratorSet = false;
+  ringHead = ringTail = 0;
+  startPlaying();
   sotDEBUGOUT(15);
 }
 
-dynamicgraph::Vector &sotReader::getNextData(dynamicgraph::Vector &res,
-                                             const unsigned int time) {
-  sotDEBUGIN(15);
+void sotReader::setStreaming(const int &capacity) {
+  if (capacity < 0)
+    throw ExceptionTraces(ExceptionTraces::GENERIC,
+                          "The capacity of the streaming must be positive.");
+  stopPlaying();
+  ring.assign(static_cast<std::size_t>(capacity), dynamicgraph::Vector());
+  ringHead = ringTail = 0;
+  startPlaying();
+}
+
+void sotReader::stopPlaying(void) {
+  playing = false;
+  while (players != 0)
+    std::this_thread::yield();
+  stopStreaming();
+}
+
+void sotReader::startPlaying(void) {
+  startStreaming();
+  playing = true;
+}
+
+void sotReader::startStreaming(void) {
+  if (!ring.empty() && !streamThread.joinable()) {
+    streamStop = false;
+    streamThread = std::thread(&sotReader::stream, this);
+  }
+}
+
+void sotReader::stopStreaming(void) {
+  if (streamThread.joinable()) {
+    streamStop = true;
+    streamThread.join();
+  }
+}
+
+void sotReader::stream(void) {
+  const std::size_t capacity = ring.size();
+  while (!streamStop) {
+    const std::size_t head = ringHead.load(std::memory_order_relaxed);
+    if (head - ringTail.load(std::memory_order_acquire) == capacity) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      continue;
+    }
+    if (!nextLine())
+      return;
+
+    dynamicgraph::Vector &row = ring[head % capacity];
+    if (record != NULL) {
+      row = Eigen::Map<const dynamicgraph::Vector>(
+          record, static_cast<Eigen::Index>(recordWidth));
+    } else {
+      // All the values are parsed, the selection being applied when the
+      // line is played.
+      row.resize(static_cast<Eigen::Index>(tokens.size()));
+      for (std::size_t i = 0; i < tokens.size(); ++i)
+        row(static_cast<Eigen::Index>(i)) = std::strtod(tokens[i], NULL);
+    }
+    ringHead.store(head + 1, std::memory_order_release);
+  }
+}
 
+bool sotReader::nextLine(void) {
+  bool skip = iteratorSet;
   if (!iteratorSet) {
     sotDEBUG(15) << "Start the list" << std::endl;
-    currentData = dataSet.begin();
+    currentFile = 0;
+    currentLine = files.empty() ? NULL : files[0].data + files[0].offset;
     iteratorSet = true;
-  } else if (currentData != dataSet.end()) {
-    ++currentData;
+  }
+  // Files loaded after the end of the data was reached are played next.
+  if (currentLine == NULL && currentFile < files.size()) {
+    currentLine = files[currentFile].data + files[currentFile].offset;
+    skip = false;
   }
 
-  if (currentData == dataSet.end()) {
-    sotDEBUGOUT(15);
-    return res;
+  while (currentLine != NULL) {
+    const File &file = files[currentFile];
+    const char *fileEnd = file.data + file.size;
+    // Beginning of the next line, fileEnd if there is none.
+    const char *next;
+
+    if (file.width != 0) {
+      // A line of a binary trace is a record. An incomplete last record is
+      // ignored.
+      const std::size_t recordBytes = file.width * sizeof(double);
+      if (!skip) {
+        record = reinterpret_cast<const double *>(currentLine);
+        recordWidth = file.width;
+        return true;
+      }
+      next = currentLine + recordBytes;
+      if (static_cast<std::size_t>(fileEnd - next) < recordBytes)
+        next = fileEnd;
+    } else {
+      const char *lineEnd = static_cast<const char *>(
+          std::memchr(currentLine, '\n', fileEnd - currentLine));
+      if (lineEnd == NULL)
+        lineEnd = fileEnd;
+      next = lineEnd == fileEnd ? fileEnd : lineEnd + 1;
+
+      if (!skip) {
+        const char *cur = currentLine, *end = lineEnd;
+        if (lineEnd == fileEnd) {
+          lastLine.assign(currentLine, lineEnd);
+          cur = lastLine.c_str();
+          end = cur + lastLine.size();
+        }
+        // The values of a line end at the first token which is not a
+        // number, so that a comment may follow them.
+        tokens.clear();
+        while (cur != end) {
+          while (cur != end && std::isspace(static_cast<unsigned char>(*cur)))
+            ++cur;
+          if (cur == end || !startsWithNumber(cur, end))
+            break;
+          tokens.push_back(cur);
+          while (cur != end &&
+                 !std::isspace(static_cast<unsigned char>(*cur)))
+            ++cur;
+        }
+        // Lines which do not start with a number are skipped.
+        if (!tokens.empty()) {
+          record = NULL;
+          return true;
+        }
+      }
+    }
+    skip = false;
+
+    if (next != fileEnd)
+      currentLine = next;
+    else if (++currentFile < files.size())
+      currentLine = files[currentFile].data + files[currentFile].offset;
+    else
+      currentLine = NULL;
   }
+  return false;
+}
 
-  const Flags &selection = selectionSIN(time);
-  const std::vector<double> &curr = *currentData;
+dynamicgraph::Vector &sotReader::getNextData(dynamicgraph::Vector &res,
+                                             const unsigned int time) {
+  sotDEBUGIN(15);
 
-  unsigned int dim = 0;
-  for (unsigned int i = 0; i < curr.size(); ++i)
-    if (selection(i))
-      dim++;
+  const Flags &selection = selectionSIN(time);
 
-  res.resize(dim);
-  int cursor = 0;
-  for (unsigned int i = 0; i < curr.size(); ++i)
-    if (selection(i))
-      res(cursor++) = curr[i];
+  // Both operations are sequentially consistent: either stopPlaying sees
+  // this read in progress, or this read sees that playing stopped.
+  // res is not the buffer of the previous output, which is copied when no
+  // line is played.
+  ++players;
+  try {
+    if (!playing || !playNextLine(selection, res))
+      res = vectorSOUT.accessCopy();
+  } catch (...) {
+    --players;
+    throw;
+  }
+  --players;
 
   sotDEBUGOUT(15);
   return res;
 }
 
+bool sotReader::playNextLine(const Flags &selection,
+                             dynamicgraph::Vector &res) {
+  // Streaming: take the next line parsed ahead, if it is ready.
+  if (!ring.empty()) {
+    const std::size_t tail = ringTail.load(std::memory_order_relaxed);
+    if (tail == ringHead.load(std::memory_order_acquire)) {
+      sotDEBUG(15) << "No line ready" << std::endl;
+      return false;
+    }
+    const dynamicgraph::Vector &row = ring[tail % ring.size()];
+    selection.gatherRows(row, res);
+    ringTail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  if (!nextLine())
+    return false;
+
+  if (record != NULL) {
+    selection.gatherRows(Eigen::Map<const dynamicgraph::Vector>(
+                             record, static_cast<Eigen::Index>(recordWidth)),
+                         res);
+    return true;
+  }
+
+  // Only the selected values are converted.
+  const Flags::Indices_t &selected =
+      selection.selectedIndices(static_cast<Eigen::Index>(tokens.size()));
+  res.resize(static_cast<Eigen::Index>(selected.size()));
+  for (std::size_t i = 0; i < selected.size(); ++i)
+    res(static_cast<Eigen::Index>(i)) = std::strtod(tokens[selected[i]], NULL);
+  return true;
+}
+
 dynamicgraph::Matrix &sotReader::getNextMatrix(dynamicgraph::Matrix &res,
                                                const unsigned int time) {
   sotDEBUGIN(15);
@@ -170,6 +431,12 @@ void sotReader::initCommands() {
   addCommand("load",
              dc::makeCommandVoid1(*this, &sotReader::load, "load file"));
   addCommand("resize", dc::makeCommandVoid2(*this, &sotReader::resize, " "));
+  addCommand("setStreaming",
+             dc::makeCommandVoid1(
+                 *this, &sotReader::setStreaming,
+                 dc::docCommandVoid1("Parse lines ahead in a thread, 0 to "
+                                     "parse each line when it is played.",
+                                     "capacity in lines (int)")));
 }
 
 void sotReader::resize(const int &row, const int &col) {
@@ -0,0 +1,3 @@
+#include <sot/core/recorder.hh>
+
+typedef boost::mpl::vector<dynamicgraph::sot::Recorder> entities_t;
@@ -0,0 +1,276 @@
+/*
+ * Copyright 2020,
+ * CNRS/AIST
+ *
+ */
+
+#include <boost/bind.hpp>
+
+#include <dynamic-graph/all-commands.h>
+#include <dynamic-graph/exception-traces.h>
+#include <dynamic-graph/factory.h>
+
+#include <sot/core/binary-trace.hh>
+#include <sot/core/recorder.hh>
+
+#include <algorithm>
+#include <chrono>
+
+namespace dynamicgraph {
+namespace sot {
+
+DYNAMICGRAPH_FACTORY_ENTITY_PLUGIN(Recorder, "Recorder");
+
+/* --------------------------------------------------------------------- */
+/* --- CLASS ----------------------------------------------------------- */
+/* --------------------------------------------------------------------- */
+
+Recorder::Recorder(const std::string &name)
+    : Entity(name),
+      triggerSOUT(boost::bind(&Recorder::record, this, _1, _2), sotNOSIGNAL,
+                  "Recorder(" + name + ")::output(int)::trigger"),
+      ringHead(0), ringTail(0), dropped(0), recording(false), recordUsers(0),
+      writeStop(false) {
+  using namespace dynamicgraph::command;
+
+  signalRegistration(triggerSOUT);
+
+  addCommand("addDouble",
+             makeCommandVoid1(*this, &Recorder::addDouble,
+                              docCommandVoid1("Add a double input.",
+                                              "name of the signal (string)")));
+  addCommand("addVector",
+             makeCommandVoid2(
+                 *this, &Recorder::addVector,
+                 docCommandVoid2("Add a vector input.",
+                                 "name of the signal (string)",
+                                 "size of the vector (int)")));
+  addCommand("addMatrix",
+             makeCommandVoid3(
+                 *this, &Recorder::addMatrix,
+                 docCommandVoid3("Add a matrix input.",
+                                 "name of the signal (string)",
+                                 "number of rows (int)",
+                                 "number of columns (int)")));
+  addCommand("open",
+             makeCommandVoid2(
+                 *this, &Recorder::open,
+                 docCommandVoid2("Start recording in a file.",
+                                 "name of the file (string)",
+                                 "number of records of the ring (int)")));
+  addCommand("close",
+             makeCommandVoid0(*this, &Recorder::close,
+                              docCommandVoid0("Write the records left in the "
+                                              "ring and close the file.")));
+  addCommand("getDropped",
+             makeCommandReturnType0(*this, &Recorder::getDropped,
+                                    "Get the number of records dropped "
+                                    "because the ring was full."));
+}
+
+Recorder::~Recorder() {
+  close();
+  for (std::size_t i = 0; i < channels.size(); ++i) {
+    const Channel &c = channels[i];
+    SignalBase<int> *sig;
+    if (c.doubleSIN != NULL)
+      sig = c.doubleSIN;
+    else if (c.vectorSIN != NULL)
+      sig = c.vectorSIN;
+    else
+      sig = c.matrixSIN;
+    signalDeregistration(sig->shortName());
+    triggerSOUT.removeDependency(*sig);
+    delete sig;
+  }
+}
+
+std::string Recorder::getDocString() const {
+  return "Record signals in a binary trace.\n"
+         "\n"
+         "  Commands addDouble (name), addVector (name, size) and addMatrix\n"
+         "  (name, rows, cols) add an input signal. Command open (filename,\n"
+         "  capacity) writes the header of the file. Then, each evaluation\n"
+         "  of signal trigger copies the inputs in a ring of capacity\n"
+         "  records, which a thread writes to the file until command close.\n"
+         "  The file is loaded by the Reader entity.\n";
+}
+
+/* --- CHANNELS ---------------------------------------------------------- */
+
+Recorder::Channel &Recorder::addChannel(const std::string &name,
+                                        const int &rows, const int &cols) {
+  if (ring.cols() != 0)
+    throw ExceptionTraces(ExceptionTraces::GENERIC,
+                          "Cannot add signal " + name + " while recording.");
+  if (rows <= 0 || cols <= 0)
+    throw ExceptionTraces(ExceptionTraces::GENERIC,
+                          "Size of signal " + name + " must be positive.");
+  for (std::size_t i = 0; i < channels.size(); ++i)
+    if (channels[i].name == name)
+      throw ExceptionTraces(ExceptionTraces::GENERIC,
+                            "Signal " + name + " already exists.");
+
+  Channel c;
+  c.name = name;
+  c.rows = rows;
+  c.cols = cols;
+  c.doubleSIN = NULL;
+  c.vectorSIN = NULL;
+  c.matrixSIN = NULL;
+  channels.push_back(c);
+  return channels.back();
+}
+
+void Recorder::addDouble(const std::string &name) {
+  Channel &c = addChannel(name, 1, 1);
+  c.doubleSIN = new SignalPtr<double, int>(
+      NULL, "Recorder(" + getName() + ")::input(double)::" + name);
+  signalRegistration(*c.doubleSIN);
+  triggerSOUT.addDependency(*c.doubleSIN);
+}
+
+void Recorder::addVector(const std::string &name, const int &size) {
+  Channel &c = addChannel(name, size, 1);
+  c.vectorSIN = new SignalPtr<Vector, int>(
+      NULL, "Recorder(" + getName() + ")::input(vector)::" + name);
+  signalRegistration(*c.vectorSIN);
+  triggerSOUT.addDependency(*c.vectorSIN);
+}
+
+void Recorder::addMatrix(const std::string &name, const int &rows,
+                         const int &cols) {
+  Channel &c = addChannel(name, rows, cols);
+  c.matrixSIN = new SignalPtr<Matrix, int>(
+      NULL, "Recorder(" + getName() + ")::input(matrix)::" + name);
+  signalRegistration(*c.matrixSIN);
+  triggerSOUT.addDependency(*c.matrixSIN);
+}
+
+/* --- FILE -------------------------------------------------------------- */
+
+void Recorder::open(const std::string &filename, const int &capacity) {
+  close();
+  if (capacity <= 0)
+    throw ExceptionTraces(ExceptionTraces::GENERIC,
+                          "The capacity of the ring must be positive.");
+
+  BinaryTraceHeader header;
+  header.entries.resize(channels.size());
+  for (std::size_t i = 0; i < channels.size(); ++i) {
+    header.entries[i].name = channels[i].name;
+    header.entries[i].rows = static_cast<uint32_t>(channels[i].rows);
+    header.entries[i].cols = static_cast<uint32_t>(channels[i].cols);
+  }
+
+  file.open(filename.c_str(),
+            std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file)
+    throw ExceptionTraces(ExceptionTraces::NOT_OPEN,
+                          "Could not open file " + filename);
+  header.write(file);
+
+  ring.resize(static_cast<Eigen::Index>(header.recordSize()), capacity);
+  ringHead = ringTail = dropped = 0;
+  writeStop = false;
+  writeThread = std::thread(&Recorder::write, this);
+  recording = true;
+}
+
+void Recorder::close(void) {
+  // Wait for the record in progress, if any, before releasing the ring.
+  recording = false;
+  while (recordUsers != 0)
+    std::this_thread::yield();
+
+  if (writeThread.joinable()) {
+    writeStop = true;
+    writeThread.join();
+  }
+  if (file.is_open())
+    file.close();
+  ring.resize(ring.rows(), 0);
+}
+
+int Recorder::getDropped(void) const { return static_cast<int>(dropped); }
+
+void Recorder::write(void) {
+  const std::size_t capacity = static_cast<std::size_t>(ring.cols());
+  const std::streamsize recordBytes =
+      static_cast<std::streamsize>(ring.rows() * sizeof(double));
+  for (;;) {
+    // Read before the head, so that all the records are written on stop.
+    const bool stop = writeStop.load(std::memory_order_acquire);
+    const std::size_t tail = ringTail.load(std::memory_order_relaxed);
+    const std::size_t head = ringHead.load(std::memory_order_acquire);
+    if (tail == head) {
+      if (stop)
+        return;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      continue;
+    }
+
+    // The records up to the end of the ring are contiguous.
+    const std::size_t begin = tail % capacity;
+    const std::size_t n = std::min(head - tail, capacity - begin);
+    file.write(reinterpret_cast<const char *>(
+                   ring.col(static_cast<Eigen::Index>(begin)).data()),
+               static_cast<std::streamsize>(n) * recordBytes);
+    ringTail.store(tail + n, std::memory_order_release);
+  }
+}
+
+/* --- COMPUTE ----------------------------------------------------------- */
+
+int &Recorder::record(int &dummy, const int &time) {
+  // Both operations are sequentially consistent: either close sees this
+  // record in progress, or this record sees that recording stopped.
+  ++recordUsers;
+  try {
+    if (recording)
+      push(time);
+  } catch (...) {
+    --recordUsers;
+    throw;
+  }
+  --recordUsers;
+  return dummy;
+}
+
+void Recorder::push(const int &time) {
+  const std::size_t capacity = static_cast<std::size_t>(ring.cols());
+  const std::size_t head = ringHead.load(std::memory_order_relaxed);
+  if (head - ringTail.load(std::memory_order_acquire) == capacity) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic,
+                        Eigen::RowMajor>
+      RowMajorMatrix;
+  double *values = ring.col(static_cast<Eigen::Index>(head % capacity)).data();
+  *values++ = time;
+  for (std::size_t i = 0; i < channels.size(); ++i) {
+    const Channel &c = channels[i];
+    if (c.doubleSIN != NULL) {
+      *values = (*c.doubleSIN)(time);
+    } else if (c.vectorSIN != NULL) {
+      const Vector &v = (*c.vectorSIN)(time);
+      if (v.size() != c.rows)
+        throw ExceptionTraces(ExceptionTraces::GENERIC,
+                              "Wrong size of input signal " + c.name);
+      Eigen::Map<Vector>(values, c.rows) = v;
+    } else {
+      const Matrix &m = (*c.matrixSIN)(time);
+      if (m.rows() != c.rows || m.cols() != c.cols)
+        throw ExceptionTraces(ExceptionTraces::GENERIC,
+                              "Wrong size of input signal " + c.name);
+      Eigen::Map<RowMajorMatrix>(values, c.rows, c.cols) = m;
+    }
+    values += c.rows * c.cols;
+  }
+  ringHead.store(head + 1, std::memory_order_release);
+}
+
+} /* namespace sot */
+} /* namespace dynamicgraph */
@@ -279,6 +279,50 @@ BOOST_AUTO_TEST_CASE(check_value) {
     testFeatureGeneric.checkValue();
 }
 
+BOOST_AUTO_TEST_CASE(selection) {
+  const int dim = 6, nv = 4;
+  FeatureGeneric feature("featureGenericSelection");
+  Task task("taskGenericSelection");
+  task.addFeature(feature);
+
+  Vector e(Vector::Random(dim));
+  Matrix J(Matrix::Random(dim, nv));
+  feature.errorSIN = e;
+  feature.jacobianSIN = J;
+
+  // Full selection without reference: the inputs are passed through.
+  int time = 1;
+  feature.selectionSIN = Flags(true);
+  BOOST_CHECK(feature.errorSOUT(time).isApprox(e));
+  BOOST_CHECK(feature.jacobianSOUT(time).isApprox(J));
+  BOOST_CHECK(task.jacobianSOUT(time).isApprox(J));
+  const unsigned int version = task.getTopologyVersion(time);
+  BOOST_CHECK_EQUAL(task.getTaskDimension(time), dim);
+
+  // The topology does not change as long as the dimension does not.
+  ++time;
+  feature.selectionSIN = Flags(true);
+  BOOST_CHECK(task.errorSOUT(time).isApprox(e));
+  BOOST_CHECK_EQUAL(task.getTopologyVersion(time), version);
+
+  // Partial selection.
+  ++time;
+  feature.selectionSIN = Flags("101001");
+  const Vector &es = feature.errorSOUT(time);
+  const Matrix &Js = feature.jacobianSOUT(time);
+  BOOST_REQUIRE_EQUAL(es.size(), 3);
+  BOOST_REQUIRE_EQUAL(Js.rows(), 3);
+  const int rows[] = {0, 2, 5};
+  for (int k = 0; k < 3; ++k) {
+    BOOST_CHECK_EQUAL(es(k), e(rows[k]));
+    BOOST_CHECK(Js.row(k).isApprox(J.row(rows[k])));
+  }
+  BOOST_CHECK(task.jacobianSOUT(time).isApprox(Js));
+  BOOST_CHECK(task.errorSOUT(time).isApprox(es));
+  BOOST_CHECK_NE(task.getTopologyVersion(time), version);
+  BOOST_CHECK_EQUAL(task.getTaskDimension(time), 3);
+}
+
 BOOST_AUTO_TEST_SUITE_END() // feature_generic
 
 MatrixHomogeneous randomM() {
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2020,
+ * CNRS/AIST
+ *
+ */
+
+#include <iostream>
+#include <sot/core/debug.hh>
+
+#include <dynamic-graph/linear-algebra.h>
+#include <sot/core/feature-joint-limits.hh>
+
+using namespace dynamicgraph;
+using namespace dynamicgraph::sot;
+
+#define BOOST_TEST_MODULE test - feature - joint - limits
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(test_feature_joint_limits_selection) {
+  FeatureJointLimits feature("joint_limits");
+  Vector q(4), upper(4), lower(4);
+  q << 0.1, 0.2, 0.3, 0.4;
+  upper << 1., 2., 4., 5.;
+  lower << -1., 0., 0., 0.;
+  feature.jointSIN = q;
+  feature.upperJlSIN = upper;
+  feature.lowerJlSIN = lower;
+
+  // The selection changes twice with the same number of joints, each one
+  // being kept for a few evaluations.
+  const char *selections[3] = {"1100", "0011", "0110"};
+  int t = 0;
+  for (int s = 0; s < 3; ++s) {
+    const Flags fl(selections[s]);
+    feature.selectionSIN = fl;
+    for (int k = 0; k < 3; ++k) {
+      Matrix expected = Matrix::Zero(2, 4);
+      for (Matrix::Index i = 0, row = 0; i < 4; ++i)
+        if (fl(static_cast<int>(i)))
+          expected(row++, i) = 1. / (upper(i) - lower(i));
+      const Matrix &J = feature.jacobianSOUT(++t);
+      BOOST_CHECK_EQUAL(J, expected);
+    }
+  }
+}
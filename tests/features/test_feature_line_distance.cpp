@@ -0,0 +1,99 @@
+/*
+ * Copyright 2020,
+ * CNRS/AIST
+ *
+ */
+
+#include <iostream>
+#include <sot/core/debug.hh>
+
+#include <dynamic-graph/linear-algebra.h>
+#include <sot/core/feature-line-distance.hh>
+
+using namespace dynamicgraph;
+using namespace dynamicgraph::sot;
+
+#define BOOST_TEST_MODULE test - feature - line - distance
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+MatrixHomogeneous pose(const Vector6d &nu) {
+  MatrixHomogeneous M;
+  M.setIdentity();
+  M.translation() = nu.head<3>();
+  M.linear() = Eigen::AngleAxisd(nu.tail<3>().norm(), nu.tail<3>().normalized())
+                   .toRotationMatrix();
+  return M;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_feature_line_distance_jacobian) {
+  FeatureLineDistance feature("line");
+  Vector6d nu;
+  nu << 0.1, -0.3, 0.5, 0.4, 0.2, -0.7;
+  const MatrixHomogeneous M = pose(nu);
+  Vector vect(3), posRef(6);
+  vect << 0.2, 0.9, -0.4;
+  posRef << 1., 0.5, -0.2, 0.3, -0.8, 0.6;
+
+  feature.positionSIN = M;
+  feature.vectorSIN = vect;
+  feature.positionRefSIN = posRef;
+  feature.articularJacobianSIN = Matrix(Matrix::Identity(6, 6));
+
+  const Matrix J = feature.jacobianSOUT(0);
+  BOOST_CHECK_EQUAL(J.rows(), 1);
+
+  // The Jacobian is the derivative wrt a twist of the body expressed in the
+  // body frame.
+  const double eps = 1e-6;
+  int time = 1;
+  for (int i = 0; i < 6; ++i) {
+    MatrixHomogeneous dM;
+    dM.setIdentity();
+    if (i < 3)
+      dM.translation()(i) = eps;
+    else
+      dM.linear() = Eigen::AngleAxisd(eps, Eigen::Vector3d::Unit(i - 3))
+                        .toRotationMatrix();
+    feature.positionSIN = M * dM;
+    const double ep = feature.errorSOUT(time++)(0);
+    feature.positionSIN = M * dM.inverse();
+    const double em = feature.errorSOUT(time++)(0);
+    BOOST_CHECK_SMALL((ep - em) / (2 * eps) - J(0, i), 1e-6);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_feature_line_distances) {
+  const int N = 3;
+  Vector6d nu;
+  nu << 0.1, -0.3, 0.5, 0.4, 0.2, -0.7;
+  const MatrixHomogeneous M = pose(nu);
+  const Matrix Jq(Matrix::Random(6, 8));
+  const Vector vect(Vector::Random(3 * N)), posRef(Vector::Random(6 * N));
+
+  FeatureLineDistances lines("lines");
+  lines.positionSIN = M;
+  lines.vectorSIN = vect;
+  lines.positionRefSIN = posRef;
+  lines.articularJacobianSIN = Jq;
+  lines.selectionSIN = Flags("101");
+
+  Matrix J(2, 8);
+  Vector e(2);
+  int k = 0;
+  for (int i = 0; i < N; i += 2) {
+    FeatureLineDistance line("line" + std::string(1, char('0' + i)));
+    line.positionSIN = M;
+    line.vectorSIN = Vector(vect.segment<3>(3 * i));
+    line.positionRefSIN = Vector(posRef.segment<6>(6 * i));
+    line.articularJacobianSIN = Jq;
+    J.row(k) = line.jacobianSOUT(0);
+    e(k++) = line.errorSOUT(0)(0);
+  }
+
+  BOOST_CHECK_EQUAL(lines.dimensionSOUT(0), 2u);
+  BOOST_CHECK(lines.errorSOUT(0).isApprox(e));
+  BOOST_CHECK(lines.jacobianSOUT(0).isApprox(J));
+}
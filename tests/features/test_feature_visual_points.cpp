@@ -0,0 +1,70 @@
+/*
+ * Copyright 2020,
+ * CNRS/AIST
+ *
+ */
+
+#include <iostream>
+#include <sot/core/debug.hh>
+
+#include <dynamic-graph/linear-algebra.h>
+#include <sot/core/exception-feature.hh>
+#include <sot/core/feature-visual-point.hh>
+#include <sot/core/feature-visual-points.hh>
+
+using namespace dynamicgraph;
+using namespace dynamicgraph::sot;
+
+#define BOOST_TEST_MODULE test - feature - visual - points
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(test_feature_visual_points) {
+  const int N = 3;
+  Vector xy(2 * N), xyDes(2 * N), Z(N);
+  xy << 0.1, -0.2, 0.3, 0.05, -0.4, 0.25;
+  xyDes << 0., 0., 0.2, 0.1, -0.3, 0.2;
+  Z << 1., 2., 0.5;
+  Matrix Jq(Matrix::Random(6, 10));
+
+  FeatureVisualPoints points("points"), pointsDes("pointsDes");
+  points.xySIN = xy;
+  points.ZSIN = Z;
+  points.articularJacobianSIN = Jq;
+  pointsDes.xySIN = xyDes;
+  points.setReference(&pointsDes);
+  // Coordinate y of the first point and the two last points.
+  points.selectionSIN = Flags("011111");
+
+  // Compare with one FeatureVisualPoint per point.
+  Matrix J(0, 10);
+  Vector e(0);
+  for (int i = 0; i < N; ++i) {
+    const std::string suffix(1, char('0' + i));
+    FeatureVisualPoint point("point" + suffix), pointDes("pointDes" + suffix);
+    point.xySIN = Vector(xy.segment<2>(2 * i));
+    point.ZSIN = Z(i);
+    point.articularJacobianSIN = Jq;
+    pointDes.xySIN = Vector(xyDes.segment<2>(2 * i));
+    point.setReference(&pointDes);
+    if (i == 0)
+      point.selectionSIN = FeatureVisualPoint::selectY();
+
+    const Matrix &Ji = point.jacobianSOUT(1);
+    const Vector &ei = point.errorSOUT(1);
+    J.conservativeResize(J.rows() + Ji.rows(), Eigen::NoChange);
+    J.bottomRows(Ji.rows()) = Ji;
+    e.conservativeResize(e.size() + ei.size());
+    e.tail(ei.size()) = ei;
+  }
+
+  BOOST_CHECK_EQUAL(points.dimensionSOUT(1), 5u);
+  BOOST_CHECK(points.jacobianSOUT(1).isApprox(J));
+  BOOST_CHECK(points.errorSOUT(1).isApprox(e));
+
+  Z(1) = -1.;
+  points.ZSIN = Z;
+  BOOST_CHECK_THROW(points.jacobianSOUT(2), ExceptionFeature);
+  points.ZSIN = Vector(Vector::Ones(N + 1));
+  BOOST_CHECK_THROW(points.jacobianSOUT(3), ExceptionFeature);
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2020,
+ * CNRS/AIST
+ *
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+#include <sot/core/debug.hh>
+
+#include <dynamic-graph/linear-algebra.h>
+#include <sot/core/exception-feature.hh>
+#include <sot/core/visual-point-projecter.hh>
+
+using namespace dynamicgraph;
+using namespace dynamicgraph::sot;
+
+#define BOOST_TEST_MODULE test - visual - point - projecter
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(test_visual_point_projecter_cached) {
+  VisualPointProjecter exact("exact"), cached("cached");
+  cached.setCached(true);
+
+  MatrixHomogeneous M;
+  M.setIdentity();
+  M.translation() << 0.1, 0., -1.;
+  exact.m_transfoSIN = M;
+  cached.m_transfoSIN = M;
+
+  // The point moves at constant speed, and the camera of cached only sees
+  // it every 3 iterations.
+  const int period = 3;
+  Vector p0(3), velocity(3), p(3), firstGaze;
+  p0 << 0.3, 0.2, 1.;
+  velocity << 0.01, -0.005, 0.02;
+  for (int t = 0; t < 4 * period; ++t) {
+    p = p0 + t * velocity;
+    exact.m_point3DSIN = p;
+    if (t % period == 0)
+      cached.m_point3DSIN = p;
+
+    const Vector &exactGaze = exact.m_point3DgazeSOUT(t);
+    const Vector &exact2D = exact.m_point2DSOUT(t);
+    const Vector &cachedGaze = cached.m_point3DgazeSOUT(t);
+    const Vector &cached2D = cached.m_point2DSOUT(t);
+
+    if (t == 0)
+      firstGaze = exactGaze;
+    if (t % period == 0) {
+      // At an update, the projection is exact.
+      BOOST_CHECK(cachedGaze.isApprox(exactGaze));
+      BOOST_CHECK(cached2D.isApprox(exact2D));
+      BOOST_CHECK_CLOSE(cached.m_depthSOUT(t), exact.m_depthSOUT(t), 1e-9);
+    } else if (t > period) {
+      // In between, the point in the camera frame is extrapolated from the
+      // last two updates, which is exact for a motion at constant speed.
+      BOOST_CHECK(cachedGaze.isApprox(exactGaze));
+
+      // The projection is linearised at the last update.
+      const int last = t - t % period;
+      const Vector gaze = M.inverse() * Eigen::Vector3d(p0 + last * velocity);
+      const double z = gaze(2);
+      Vector expected(2);
+      expected << gaze(0) / z + (cachedGaze(0) - gaze(0)) / z -
+                      gaze(0) / (z * z) * (cachedGaze(2) - z),
+          gaze(1) / z + (cachedGaze(1) - gaze(1)) / z -
+              gaze(1) / (z * z) * (cachedGaze(2) - z);
+      BOOST_CHECK(cached2D.isApprox(expected));
+      // The linearisation error is of second order in the displacement.
+      BOOST_CHECK_SMALL((cached2D - exact2D).norm(), 1e-3);
+    } else {
+      // Before the second update, the velocity is unknown and the
+      // projection is held.
+      BOOST_CHECK(cachedGaze.isApprox(firstGaze));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_visual_point_projecter_stopped) {
+  MatrixHomogeneous M;
+  M.setIdentity();
+  M.translation() << 0.1, 0., -1.;
+  const int period = 3, last = 2 * period;
+  Vector p0(3), velocity(3);
+  p0 << 0.3, 0.2, 1.;
+  velocity << 0.01, -0.005, 0.02;
+  const Eigen::Vector3d gazeVelocity = M.linear().transpose() * velocity;
+
+  // By default, the extrapolation stops after the interval between the two
+  // last updates.
+  const int horizons[2] = {0, 1};
+  const int expectedHorizons[2] = {period, 1};
+  for (int h = 0; h < 2; ++h) {
+    VisualPointProjecter cached("cached_stopped_" + std::to_string(h));
+    cached.setCached(true);
+    cached.setExtrapolationHorizon(horizons[h]);
+    cached.m_transfoSIN = M;
+
+    // The point moves until the last update, then its input stops.
+    for (int t = 0; t <= last; t += period) {
+      cached.m_point3DSIN = Vector(p0 + t * velocity);
+      cached.m_point3DgazeSOUT(t);
+    }
+    const Vector lastGaze = cached.m_point3DgazeSOUT(last);
+    for (int t = last + 1; t < last + 10 * period; ++t) {
+      const Vector expected =
+          lastGaze + gazeVelocity * std::min(t - last, expectedHorizons[h]);
+      BOOST_CHECK(cached.m_point3DgazeSOUT(t).isApprox(expected));
+    }
+  }
+  BOOST_CHECK_THROW(VisualPointProjecter("cached_negative")
+                        .setExtrapolationHorizon(-1),
+                    ExceptionFeature);
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2020,
+ * CNRS/AIST
+ *
+ */
+
+#include <iostream>
+#include <sot/core/debug.hh>
+
+#include <dynamic-graph/entity.h>
+#include <dynamic-graph/factory.h>
+#include <sot/core/exception-tools.hh>
+#include <sot/core/filter-bank.hh>
+
+using namespace dynamicgraph;
+using namespace dynamicgraph::sot;
+
+#define BOOST_TEST_MODULE test - filter - bank
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(test_filter_bank) {
+  FilterBank bank("filter_bank");
+  bank.addAverage("a", 3, 0.9);
+  bank.addDerivative("b", 4, 0.01);
+  bank.addAverage("c", 2, 0.5);
+  BOOST_CHECK_THROW(bank.addAverage("a", 3, 0.9), ExceptionTools);
+  BOOST_CHECK_THROW(bank.setAlpha("b", 0.9), ExceptionTools);
+  BOOST_CHECK_THROW(bank.setTimestep("c", 0.1), ExceptionTools);
+
+  FilterBank::SignalIn_t &aIn = dynamic_cast<FilterBank::SignalIn_t &>(
+      bank.getSignal("sin_a"));
+  FilterBank::SignalIn_t &bIn = dynamic_cast<FilterBank::SignalIn_t &>(
+      bank.getSignal("sin_b"));
+  FilterBank::SignalIn_t &cIn = dynamic_cast<FilterBank::SignalIn_t &>(
+      bank.getSignal("sin_c"));
+  FilterBank::SignalOut_t &aOut = dynamic_cast<FilterBank::SignalOut_t &>(
+      bank.getSignal("sout_a"));
+  FilterBank::SignalOut_t &bOut = dynamic_cast<FilterBank::SignalOut_t &>(
+      bank.getSignal("sout_b"));
+  FilterBank::SignalOut_t &cOut = dynamic_cast<FilterBank::SignalOut_t &>(
+      bank.getSignal("sout_c"));
+
+  srand(0);
+  Vector a = Vector::Zero(3), c = Vector::Zero(2), bPrev;
+  for (int t = 0; t < 10; ++t) {
+    Vector aVal = Vector::Random(3), bVal = Vector::Random(4),
+           cVal = Vector::Random(2);
+    aIn = aVal;
+    bIn = bVal;
+    cIn = cVal;
+
+    a = 0.9 * a + 0.1 * aVal;
+    c = 0.5 * c + 0.5 * cVal;
+    BOOST_CHECK(a.isApprox(aOut(t)));
+    BOOST_CHECK(c.isApprox(cOut(t)));
+    if (t == 0)
+      BOOST_CHECK(bOut(t).isZero());
+    else
+      BOOST_CHECK(((bVal - bPrev) / 0.01).isApprox(bOut(t)));
+    bPrev = bVal;
+  }
+
+  // As Derivator, a derivative added later is zero at its first time step.
+  bank.addDerivative("d", 2, 0.1);
+  FilterBank::SignalIn_t &dIn = dynamic_cast<FilterBank::SignalIn_t &>(
+      bank.getSignal("sin_d"));
+  FilterBank::SignalOut_t &dOut = dynamic_cast<FilterBank::SignalOut_t &>(
+      bank.getSignal("sout_d"));
+  Vector dVal(2);
+  dVal << 1., 2.;
+  aIn = Vector::Zero(3);
+  bIn = bPrev;
+  cIn = Vector::Zero(2);
+  dIn = dVal;
+  BOOST_CHECK(dOut(10).isZero());
+  BOOST_CHECK(bOut(10).isZero());
+  dIn = Vector(2 * dVal);
+  BOOST_CHECK((dVal / 0.1).isApprox(dOut(11)));
+}
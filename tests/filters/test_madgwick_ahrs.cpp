@@ -59,3 +59,36 @@ BOOST_AUTO_TEST_CASE(test_filter_differentiator) {
                               "-5.83205e-05 "
                               "0.00015"));
 }
+
+BOOST_AUTO_TEST_CASE(test_madgwick_ahrs_batch) {
+  sot::MadgwickAHRS *aFilter = new MadgwickAHRS("MadgwickAHRS_single");
+  sot::MadgwickAHRS *aBatchFilter = new MadgwickAHRS("MadgwickAHRS_batch");
+
+  double timestep = 0.001, beta = 0.01;
+  aFilter->init(timestep);
+  aFilter->set_beta(beta);
+  aBatchFilter->init(timestep);
+  aBatchFilter->set_beta(beta);
+
+  const int nbSamples = 8;
+  srand(0);
+  dynamicgraph::Matrix acc = dynamicgraph::Matrix::Random(3, nbSamples);
+  dynamicgraph::Matrix angvel = dynamicgraph::Matrix::Random(3, nbSamples);
+  acc.row(2).array() += 9.81;
+
+  dynamicgraph::Matrix quats(4, nbSamples);
+  for (int j = 0; j < nbSamples; ++j) {
+    aFilter->m_accelerometerSIN = dynamicgraph::Vector(acc.col(j));
+    aFilter->m_gyroscopeSIN = dynamicgraph::Vector(angvel.col(j));
+    aFilter->m_imu_quatSOUT.recompute(j);
+    quats.col(j) = aFilter->m_imu_quatSOUT.accessCopy();
+  }
+
+  aBatchFilter->m_accelerometer_batchSIN = acc;
+  aBatchFilter->m_gyroscope_batchSIN = angvel;
+  aBatchFilter->m_imu_quat_batchSOUT.recompute(0);
+
+  BOOST_CHECK(quats.isApprox(aBatchFilter->m_imu_quat_batchSOUT.accessCopy()));
+  BOOST_CHECK(quats.col(nbSamples - 1)
+                  .isApprox(aBatchFilter->m_imu_quatSOUT.accessCopy()));
+}
@@ -202,4 +202,36 @@ BOOST_AUTO_TEST_CASE(matrixHomo_se3Vector) {
   test_impl<MatrixHomoToSE3Vector, SE3VectorToMatrixHomo>();
 }
 
+BOOST_AUTO_TEST_CASE(test_convolution_temporal) {
+  ConvolutionTemporal aConvolution;
+  const int nsig = 5;
+  dg::Matrix kernel = dg::Matrix::Random(nsig, 4);
+  std::vector<dg::Vector> inputs;
+  dg::Vector res;
+
+  for (int t = 0; t < 12; ++t) {
+    // Change the size of the kernel on the way, the most recent samples
+    // must be kept.
+    if (t == 6)
+      kernel = dg::Matrix::Random(nsig, 3);
+    if (t == 9)
+      kernel = dg::Matrix::Random(nsig, 5);
+    inputs.push_back(dg::Vector::Random(nsig));
+    aConvolution(inputs.back(), kernel, res);
+
+    dg::Vector expected = dg::Vector::Zero(nsig);
+    for (int j = 0; j < kernel.cols() && j <= t; ++j) {
+      // Only 3 samples are kept when the kernel shrinks at t = 6, the
+      // samples before t = 6 are then lost.
+      if (t >= 9 && t - j < 6)
+        break;
+      expected.array() += kernel.col(j).array() * inputs[t - j].array();
+    }
+    BOOST_CHECK(expected.isApprox(res));
+  }
+
+  BOOST_CHECK_THROW(aConvolution(dg::Vector::Zero(nsig + 1), kernel, res),
+                    std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
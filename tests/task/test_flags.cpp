@@ -81,5 +81,34 @@ int main(void) {
   iss >> flread;
   cout << flread << endl << endl;
 
+  Flags::Indices_t expected;
+  expected.push_back(2);
+  expected.push_back(4);
+  if (flread.selectedIndices(6) != expected || flread.count(6) != 2)
+    return 1;
+  expected.push_back(5);
+  if ((!flread).count(6) != 4 || (flread | Flags(true)).count(6) != 6 ||
+      (flread | Flags("000001")).selectedIndices(6) != expected)
+    return 1;
+
+  Eigen::MatrixXd M(6, 2), Msel;
+  M << 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11;
+  flread.gatherRows(M, Msel);
+  cout << "gather rows" << endl << Msel << endl;
+  if (Msel.rows() != 2 || Msel(0, 0) != 4 || Msel(1, 1) != 9)
+    return 1;
+  Eigen::MatrixXd Mcols;
+  flread.gatherCols(M.transpose(), Mcols);
+  if (Mcols != Msel.transpose())
+    return 1;
+  Eigen::MatrixXd Mscat = Eigen::MatrixXd::Zero(6, 2);
+  flread.scatterRows(Msel, Mscat);
+  if (Mscat.row(2) != M.row(2) || Mscat.row(4) != M.row(4) ||
+      Mscat.row(0).norm() != 0)
+    return 1;
+  flread.unset(2);
+  if (flread.count(6) != 1)
+    return 1;
+
   return 0;
 }
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2020,
+ * CNRS/AIST
+ *
+ */
+
+/* Compare the times to read a trajectory with the single pass parser, the
+ * regular expressions and the binary file. */
+
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+
+#ifndef WIN32
+#include <sys/time.h>
+#else /*WIN32*/
+#include <sot/core/utils-windows.hh>
+#endif /*WIN32*/
+
+#include <sot/core/trajectory.hh>
+
+using namespace dynamicgraph::sot;
+
+static double elapsed(const struct timeval &t0, const struct timeval &t1) {
+  return (double)(t1.tv_sec - t0.tv_sec) +
+         (double)(t1.tv_usec - t0.tv_usec) / 1000. / 1000.;
+}
+
+static std::string makeTrajectory(const int nbJoints, const int nbPoints) {
+  std::ostringstream os;
+  char value[32];
+  os << "(3,(12.0,500.0),odom),(";
+  for (int j = 0; j < nbJoints; ++j)
+    os << (j ? "," : "") << "joint_" << j;
+  os << "),(";
+  for (int p = 0; p < nbPoints; ++p) {
+    os << (p ? "," : "") << "(";
+    for (int k = 0; k < 4; ++k) {
+      os << (k ? ",(" : "(");
+      for (int j = 0; k != 2 && j < nbJoints; ++j) {
+        std::sprintf(value, "%.6f", 0.001 * (p + 1) * (j - k));
+        os << (j ? "," : "") << value;
+      }
+      os << ")";
+    }
+    os << ")";
+  }
+  os << ")";
+  return os.str();
+}
+
+int main(int, char **) {
+  const int nbJoints = 30, nbPoints = 50, nbIter = 5;
+  const char *filename = "benchmark_trajectory.bin";
+  const std::string text = makeTrajectory(nbJoints, nbPoints);
+  struct timeval t0, t1;
+
+  Trajectory traj;
+  gettimeofday(&t0, NULL);
+  for (int i = 0; i < nbIter; ++i)
+    traj.deserialize(text);
+  gettimeofday(&t1, NULL);
+  const double dtParser = elapsed(t0, t1) / nbIter;
+
+  gettimeofday(&t0, NULL);
+  for (int i = 0; i < nbIter; ++i) {
+    Trajectory reference;
+    RulesJointTrajectory rules(reference);
+    std::string copy(text);
+    rules.parse_string(copy);
+  }
+  gettimeofday(&t1, NULL);
+  const double dtRegex = elapsed(t0, t1) / nbIter;
+
+  traj.saveBinaryFile(filename);
+  gettimeofday(&t0, NULL);
+  for (int i = 0; i < nbIter; ++i)
+    traj.loadBinaryFile(filename);
+  gettimeofday(&t1, NULL);
+  const double dtBinary = elapsed(t0, t1) / nbIter;
+  std::remove(filename);
+
+  std::cout << "Parsing " << nbPoints << " points of " << nbJoints
+            << " joints (" << text.size() << " bytes):\n"
+            << "  single pass parser: " << dtParser * 1000. << " ms\n"
+            << "  regular expressions: " << dtRegex * 1000. << " ms\n"
+            << "  binary file: " << dtBinary * 1000. << " ms" << std::endl;
+  return traj.nbPoints() == nbPoints ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2020,
+ * CNRS/AIST
+ *
+ */
+
+#define VP_DEBUG
+#define VP_DEBUG_MODE 50
+#include <sot/core/debug.hh>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace dynamicgraph::sot;
+
+#define BOOST_TEST_MODULE test - debug
+
+#include <boost/test/unit_test.hpp>
+
+static std::string readFile(const char *filename) {
+  std::ifstream file(filename);
+  std::ostringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+static int count(const std::string &text, const std::string &pattern) {
+  int n = 0;
+  for (std::size_t pos = text.find(pattern); pos != std::string::npos;
+       pos = text.find(pattern, pos + 1))
+    ++n;
+  return n;
+}
+
+BOOST_AUTO_TEST_CASE(test_debug) {
+  DebugTrace::openFile("test_debug_1.txt");
+  sotDEBUG(15) << "synchronous " << 1 << std::endl;
+  sotDEBUG(60) << "above the level" << std::endl;
+  DebugTrace::closeFile();
+
+  const std::string content = readFile("test_debug_1.txt");
+  BOOST_CHECK_EQUAL(count(content, "synchronous 1"), 1);
+  BOOST_CHECK_EQUAL(count(content, "test_debug.cpp"), 1);
+  BOOST_CHECK_EQUAL(count(content, "above the level"), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_debug_levels) {
+  // This file is in module TOOLS.
+  BOOST_CHECK(sotDEBUG_ENABLE(50));
+  BOOST_CHECK(!sotDEBUG_ENABLE(51));
+  // Nothing is written while the file is closed.
+  DebugTrace::closeFile();
+  BOOST_CHECK_EQUAL(DebugTrace::writtenLevels[DEBUG_TOOLS], -1);
+
+  DebugTrace::openFile("test_debug_levels.txt");
+  DebugTrace::setLevel(DEBUG_TOOLS, 10);
+  DebugTrace::setLevel(DEBUG_FEATURE, 0);
+  BOOST_CHECK_EQUAL(DebugTrace::getLevel(DEBUG_TOOLS), 10);
+  sotDEBUG(5) << "below the level" << std::endl;
+  sotDEBUG(15) << "above the level" << std::endl;
+  sotERROR << "error" << std::endl;
+  DebugTrace::setLevel(DEBUG_TOOLS, -1);
+  sotERROR << "disabled" << std::endl;
+  DebugTrace::setLevel(DEBUG_TOOLS, std::numeric_limits<int>::max());
+  DebugTrace::setLevel(DEBUG_FEATURE, std::numeric_limits<int>::max());
+  DebugTrace::closeFile();
+  BOOST_CHECK_EQUAL(DebugTrace::writtenLevels[DEBUG_TOOLS], -1);
+
+  const std::string content = readFile("test_debug_levels.txt");
+  BOOST_CHECK_EQUAL(count(content, "below the level"), 1);
+  BOOST_CHECK_EQUAL(count(content, "above the level"), 0);
+  BOOST_CHECK_EQUAL(count(content, "error"), 1);
+  BOOST_CHECK_EQUAL(count(content, "disabled"), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_debug_real_time) {
+  DebugTrace::openFile("test_debug_2.txt");
+  DebugTrace::startRealTime(1000);
+  BOOST_CHECK(DebugTrace::isRealTime());
+
+  std::thread thread([]() {
+    DebugTrace::registerThread();
+    for (int i = 0; i < 100; ++i)
+      sotDEBUG(15) << "thread " << i << std::endl;
+  });
+  for (int i = 0; i < 100; ++i)
+    sotDEBUG(15) << "main " << i << std::endl;
+  sotERROR << "error" << std::endl;
+  // A message longer than a record is truncated.
+  sotDEBUG(15) << std::string(2 * DebugTrace::SIZE, 'x') << std::endl;
+  sotDEBUG(15) << "after the truncated message" << std::endl;
+  thread.join();
+
+  DebugTrace::stopRealTime();
+  BOOST_CHECK(!DebugTrace::isRealTime());
+  DebugTrace::closeFile();
+
+  const std::string content = readFile("test_debug_2.txt");
+  BOOST_CHECK_EQUAL(count(content, "main "), 100);
+  BOOST_CHECK_EQUAL(count(content, "thread "), 100);
+  BOOST_CHECK_EQUAL(count(content, "main 99\n"), 1);
+  BOOST_CHECK_EQUAL(count(content, "\t!! "), 1);
+  // The truncated message keeps its end of line, and the next message
+  // starts on its own line.
+  BOOST_CHECK_EQUAL(
+      count(content, std::string(DebugTrace::SIZE - 1, 'x') + "\n"), 1);
+  BOOST_CHECK_EQUAL(count(content, std::string(DebugTrace::SIZE, 'x')), 0);
+  std::istringstream lines(content);
+  int nbLines = 0;
+  for (std::string line; std::getline(lines, line); ++nbLines)
+    BOOST_CHECK_EQUAL(line.substr(0, 1), "[");
+  BOOST_CHECK_EQUAL(nbLines, 203);
+}
+
+BOOST_AUTO_TEST_CASE(test_debug_dropped) {
+  DebugTrace::openFile("test_debug_3.txt");
+  DebugTrace::startRealTime(4);
+  std::thread thread([]() {
+    for (int i = 0; i < 10; ++i)
+      sotDEBUG(15) << "message " << i << std::endl;
+  });
+  thread.join();
+  DebugTrace::closeFile();
+
+  // The messages which do not fit in the ring are counted.
+  const std::string content = readFile("test_debug_3.txt");
+  const int written = count(content, "message ");
+  BOOST_CHECK(written >= 4);
+  if (written < 10)
+    BOOST_CHECK_EQUAL(count(content, " messages dropped"), 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_debug_stop_while_writing) {
+  DebugTrace::openFile("test_debug_4.txt");
+  DebugTrace::startRealTime(1000);
+  std::atomic<bool> stop(false);
+  std::thread thread([&stop]() {
+    DebugTrace::registerThread();
+    for (int i = 0; !stop; ++i)
+      sotDEBUG(15) << "message " << i << std::endl;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  // The messages written directly while the backend stops do not
+  // interleave with its last records.
+  DebugTrace::stopRealTime();
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  stop = true;
+  thread.join();
+  DebugTrace::closeFile();
+
+  std::istringstream lines(readFile("test_debug_4.txt"));
+  for (std::string line; std::getline(lines, line);)
+    if (line.substr(0, 2) != "# ")
+      BOOST_CHECK_EQUAL(count(line, "message "), 1);
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2020,
+ * CNRS/AIST
+ *
+ */
+
+#include <sot/core/exception-tools.hh>
+#include <sot/core/joint-trajectory-entity.hh>
+
+#define BOOST_TEST_MODULE joint_trajectory_entity
+#include <boost/test/unit_test.hpp>
+
+using namespace dynamicgraph;
+using namespace dynamicgraph::sot;
+
+class TestEntity : public SotJointTrajectoryEntity {
+public:
+  TestEntity() : SotJointTrajectoryEntity("traj") {}
+  using SotJointTrajectoryEntity::QueueAt;
+  using SotJointTrajectoryEntity::queueSize_;
+};
+
+// Trajectory stamped (secs, nsecs) whose first joint takes the values
+// values, at one second from each other. The last five rows are the com
+// and the cop.
+static Trajectory makeTrajectory(const unsigned long secs,
+                                 const unsigned long nsecs,
+                                 const std::vector<double> &values) {
+  const Eigen::Index n = static_cast<Eigen::Index>(values.size());
+  Trajectory traj;
+  traj.header_.stamp_ = timestamp(secs, nsecs);
+  traj.positions_.setZero(6, n);
+  for (Eigen::Index i = 0; i < n; ++i)
+    traj.positions_(0, i) = values[static_cast<std::size_t>(i)];
+  traj.velocities_.resize(0, n);
+  traj.accelerations_.resize(0, n);
+  traj.efforts_.resize(0, n);
+  traj.times_from_start_.setLinSpaced(n, 0., static_cast<double>(n - 1));
+  return traj;
+}
+
+BOOST_AUTO_TEST_CASE(post_and_blend) {
+  TestEntity entity;
+  entity.trajectorySIN = makeTrajectory(1, 0, {0., 1.});
+  entity.setBlendingWindow(4);
+  int t = 0;
+  BOOST_CHECK_EQUAL(entity.positionSOUT(++t)(0), 0.);
+
+  // The posted trajectory is exchanged with the previously posted one.
+  Trajectory posted = makeTrajectory(2, 0, {10., 11., 12.});
+  const double *data = posted.positions_.data();
+  entity.postTrajectory(posted);
+  BOOST_CHECK_EQUAL(posted.nbPoints(), 0);
+
+  // It is queued without copy, after the end of the current trajectory.
+  BOOST_CHECK_EQUAL(entity.positionSOUT(++t)(0), 1.);
+  BOOST_REQUIRE_EQUAL(entity.queueSize_, 2);
+  BOOST_CHECK_EQUAL(entity.QueueAt(1).positions_.data(), data);
+
+  // The offset from the previous output, 1 - 10, is faded out with a
+  // smoothstep over 4 evaluations.
+  const double offset = 1. - 10.;
+  const double expected[4] = {10. + (1. - 0.15625) * offset,
+                              11. + (1. - 0.5) * offset,
+                              12. + (1. - 0.84375) * offset, 12.};
+  for (int i = 0; i < 4; ++i)
+    BOOST_CHECK_CLOSE(entity.positionSOUT(++t)(0), expected[i], 1e-9);
+  BOOST_CHECK_EQUAL(entity.queueSize_, 1);
+  BOOST_CHECK_EQUAL(entity.positionSOUT(++t)(0), 12.);
+}
+
+BOOST_AUTO_TEST_CASE(retired_storage_given_back) {
+  TestEntity entity;
+  entity.trajectorySIN = makeTrajectory(1, 0, {0.});
+  int t = 0;
+  BOOST_CHECK_EQUAL(entity.positionSOUT(++t)(0), 0.);
+
+  // Each posted trajectory replaces the current one at the next
+  // evaluation, in the next slot of the queue, which has four slots.
+  std::vector<const double *> data;
+  for (unsigned long k = 1; k <= 7; ++k) {
+    Trajectory posted = makeTrajectory(1 + k, 0, {double(k)});
+    data.push_back(posted.positions_.data());
+    entity.postTrajectory(posted);
+    // The first posted trajectory is retired in its slot, which is reused
+    // by the fifth one: its storage is given back by the seventh post.
+    if (k == 7)
+      BOOST_CHECK_EQUAL(posted.positions_.data(), data[0]);
+    BOOST_CHECK_EQUAL(entity.positionSOUT(++t)(0), double(k));
+    BOOST_CHECK_EQUAL(entity.queueSize_, 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(queue_enlarged) {
+  TestEntity entity;
+  entity.trajectorySIN = makeTrajectory(1, 0, {0., 1.});
+  entity.setTimeStep(1.);
+  entity.setInterpolation("linear");
+  int t = 0;
+  BOOST_CHECK_EQUAL(entity.positionSOUT(++t)(0), 0.);
+
+  // Two trajectories are played, so that the front of the queue is not
+  // its first slot, then more trajectories than slots are queued.
+  for (unsigned long k = 1; k <= 8; ++k) {
+    Trajectory posted = makeTrajectory(k < 3 ? 1 + k : 10 + k, 0, {double(k)});
+    entity.postTrajectory(posted);
+    entity.positionSOUT(++t);
+  }
+  BOOST_REQUIRE_EQUAL(entity.queueSize_, 7);
+  for (std::size_t i = 0; i < 7; ++i)
+    BOOST_CHECK_EQUAL(entity.QueueAt(i).positions_(0, 0), double(i + 2));
+}
+
+BOOST_AUTO_TEST_CASE(timed_playback) {
+  TestEntity entity;
+  entity.trajectorySIN = makeTrajectory(1, 0, {0., 10., 30.});
+  entity.setTimeStep(0.5);
+  entity.setInterpolation("linear");
+  BOOST_CHECK_EQUAL(entity.getInterpolation(), "linear");
+  BOOST_CHECK_EQUAL(entity.getTimeStep(), 0.5);
+
+  // The clock starts at the stamp of the first trajectory.
+  int t = 0;
+  BOOST_CHECK_EQUAL(entity.positionSOUT(++t)(0), 0.);
+  BOOST_CHECK_EQUAL(entity.positionSOUT(++t)(0), 5.);
+  BOOST_CHECK_EQUAL(entity.positionSOUT(++t)(0), 10.);
+  BOOST_CHECK_EQUAL(entity.positionSOUT(++t)(0), 20.);
+
+  // A trajectory replaces the current one once its stamp is reached.
+  Trajectory posted = makeTrajectory(3, 500000000, {100., 200.});
+  entity.postTrajectory(posted);
+  BOOST_CHECK_EQUAL(entity.positionSOUT(++t)(0), 30.);
+  BOOST_CHECK_EQUAL(entity.queueSize_, 2);
+  BOOST_CHECK_EQUAL(entity.positionSOUT(++t)(0), 100.);
+  BOOST_CHECK_EQUAL(entity.positionSOUT(++t)(0), 150.);
+  BOOST_CHECK_EQUAL(entity.queueSize_, 1);
+
+  // The times from start must be increasing.
+  Trajectory wrong = makeTrajectory(4, 0, {0., 1.});
+  wrong.times_from_start_(1) = 0.;
+  BOOST_CHECK_THROW(entity.postTrajectory(wrong), ExceptionTools);
+}
+
+BOOST_AUTO_TEST_CASE(timed_playback_drift) {
+  // A trajectory stamped with a time since epoch, whose first joint goes
+  // from 0 to 1000 in 1000 s.
+  TestEntity entity;
+  Trajectory traj = makeTrajectory(1700000000, 0, {0., 1000.});
+  traj.times_from_start_(1) = 1000.;
+  entity.trajectorySIN = traj;
+  entity.setTimeStep(0.001);
+  entity.setInterpolation("linear");
+
+  // After 100 s at 1 kHz, the played time is still the number of ticks.
+  const int nbTicks = 100000;
+  for (int t = 1; t < nbTicks; ++t)
+    entity.positionSOUT(t);
+  BOOST_CHECK_SMALL(entity.positionSOUT(nbTicks)(0) - 0.001 * (nbTicks - 1),
+                    1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(timed_from_current_point) {
+  TestEntity entity;
+  entity.trajectorySIN = makeTrajectory(1, 0, {0., 10., 30.});
+  int t = 0;
+  BOOST_CHECK_EQUAL(entity.positionSOUT(++t)(0), 0.);
+  BOOST_CHECK_EQUAL(entity.positionSOUT(++t)(0), 10.);
+
+  // The settings are applied at the next evaluation, and the clock starts
+  // at the time of the current point, 1 s from the start.
+  entity.setTimeStep(0.25);
+  entity.setInterpolation("linear");
+  BOOST_CHECK_EQUAL(entity.positionSOUT(++t)(0), 15.);
+  BOOST_CHECK_EQUAL(entity.positionSOUT(++t)(0), 20.);
+
+  BOOST_CHECK_THROW(entity.setInterpolation("spline"), ExceptionTools);
+  entity.setInterpolation("none");
+  BOOST_CHECK_EQUAL(entity.getInterpolation(), "none");
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2020,
+ * CNRS/AIST
+ *
+ */
+
+#include <iostream>
+#include <sot/core/debug.hh>
+
+#include <dynamic-graph/entity.h>
+#include <dynamic-graph/factory.h>
+#include <sot/core/exception-tools.hh>
+#include <sot/core/kalman.hh>
+
+using namespace dynamicgraph;
+using namespace dynamicgraph::sot;
+
+#define BOOST_TEST_MODULE test - kalman
+
+#include <boost/test/unit_test.hpp>
+
+void setInputs(Kalman &filter, const Matrix &F, const Matrix &H,
+               const Matrix &Q, const Matrix &R, const Vector &x0,
+               const Matrix &P0) {
+  filter.modelTransitionSIN = F;
+  filter.modelMeasureSIN = H;
+  filter.noiseTransitionSIN = Q;
+  filter.noiseMeasureSIN = R;
+  filter.setStateEstimation(x0);
+  filter.setStateVariance(P0);
+}
+
+BOOST_AUTO_TEST_CASE(test_kalman_update_modes) {
+  const int n = 6, m = 3;
+  srand(0);
+  Matrix F = Matrix::Identity(n, n) + 0.01 * Matrix::Random(n, n);
+  Matrix H = Matrix::Random(m, n);
+  Matrix Q = 1e-3 * Matrix::Identity(n, n);
+  Matrix R = 1e-1 * Matrix::Identity(m, m);
+  Vector x0 = Vector::Zero(n);
+  Matrix P0 = Matrix::Identity(n, n);
+
+  Kalman standard("kalman_standard"), joseph("kalman_joseph"),
+      squareRoot("kalman_square_root");
+  joseph.setUpdateMode("joseph");
+  squareRoot.setUpdateMode("squareRoot");
+  BOOST_CHECK_EQUAL(standard.getUpdateMode(), "standard");
+  BOOST_CHECK_EQUAL(joseph.getUpdateMode(), "joseph");
+  BOOST_CHECK_EQUAL(squareRoot.getUpdateMode(), "squareRoot");
+  BOOST_CHECK_THROW(standard.setUpdateMode("unknown"), ExceptionTools);
+
+  Kalman *filters[3] = {&standard, &joseph, &squareRoot};
+  for (int i = 0; i < 3; ++i)
+    setInputs(*filters[i], F, H, Q, R, x0, P0);
+
+  Vector x(n), y(m);
+  for (int t = 1; t < 50; ++t) {
+    if (t == 25) {
+      // The square roots of the noise variances follow their changes.
+      Q *= 2.;
+      R *= 0.5;
+      for (int i = 0; i < 3; ++i) {
+        filters[i]->noiseTransitionSIN = Q;
+        filters[i]->noiseMeasureSIN = R;
+      }
+    }
+    x = F * x0;
+    y = Vector::Random(m);
+    for (int i = 0; i < 3; ++i) {
+      filters[i]->statePredictedSIN = x;
+      filters[i]->observationPredictedSIN = H * x;
+      filters[i]->measureSIN = y;
+      filters[i]->stateUpdateSOUT.recompute(t);
+    }
+    x0 = standard.stateUpdateSOUT.accessCopy();
+
+    const Matrix &P = standard.varianceUpdateSOUT.accessCopy();
+    for (int i = 1; i < 3; ++i) {
+      BOOST_CHECK(P.isApprox(filters[i]->varianceUpdateSOUT.accessCopy()));
+      BOOST_CHECK(x0.isApprox(filters[i]->stateUpdateSOUT.accessCopy()));
+    }
+  }
+
+  // Reference update with an explicit inverse.
+  const Matrix &P = standard.varianceUpdateSOUT.accessCopy();
+  Matrix Pp = F * P * F.transpose() + Q;
+  Matrix K = Pp * H.transpose() * (H * Pp * H.transpose() + R).inverse();
+  Matrix Pexpected = Pp - K * H * Pp;
+  x = F * x0;
+  for (int i = 0; i < 3; ++i) {
+    filters[i]->statePredictedSIN = x;
+    filters[i]->observationPredictedSIN = H * x;
+    filters[i]->stateUpdateSOUT.recompute(50);
+    const Matrix &Pk = filters[i]->varianceUpdateSOUT.accessCopy();
+    BOOST_CHECK(Pexpected.isApprox(Pk));
+    BOOST_CHECK((Pk - Pk.transpose()).norm() < 1e-12);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_kalman_sequential) {
+  const int n = 6, m = 3, N = 4;
+  srand(1);
+  Matrix F = Matrix::Identity(n, n) + 0.01 * Matrix::Random(n, n);
+  Matrix H = Matrix::Random(m, n);
+  Matrix Q = 1e-3 * Matrix::Identity(n, n);
+  Vector r(m);
+  r << 0.1, 0.2, 0.05;
+  Matrix R = r.asDiagonal();
+  Vector x0 = Vector::Random(n);
+  Matrix P0 = Matrix::Identity(n, n);
+
+  Kalman batch("kalman_batch"), sequential("kalman_sequential"),
+      joseph("kalman_sequential_joseph"),
+      squareRoot("kalman_sequential_square_root");
+  sequential.setMeasureProcessing("auto");
+  joseph.setMeasureProcessing("sequential");
+  joseph.setUpdateMode("joseph");
+  squareRoot.setMeasureProcessing("sequential");
+  squareRoot.setUpdateMode("squareRoot");
+  BOOST_CHECK_EQUAL(batch.getMeasureProcessing(), "batch");
+  BOOST_CHECK_EQUAL(sequential.getMeasureProcessing(), "auto");
+  BOOST_CHECK_THROW(batch.setMeasureProcessing("unknown"), ExceptionTools);
+
+  Kalman *filters[4] = {&batch, &sequential, &joseph, &squareRoot};
+  for (int i = 0; i < 4; ++i)
+    setInputs(*filters[i], F, H, Q, R, x0, P0);
+
+  Vector x(n), y(m);
+  for (int t = 1; t < 20; ++t) {
+    x = F * x0;
+    y = H * x + Vector::Random(m);
+    for (int i = 0; i < 4; ++i) {
+      filters[i]->statePredictedSIN = x;
+      filters[i]->observationPredictedSIN = H * x;
+      filters[i]->measureSIN = y;
+      filters[i]->stateUpdateSOUT.recompute(t);
+    }
+    x0 = batch.stateUpdateSOUT.accessCopy();
+
+    const Matrix &P = batch.varianceUpdateSOUT.accessCopy();
+    for (int i = 1; i < 4; ++i) {
+      BOOST_CHECK(P.isApprox(filters[i]->varianceUpdateSOUT.accessCopy()));
+      BOOST_CHECK(x0.isApprox(filters[i]->stateUpdateSOUT.accessCopy()));
+    }
+  }
+
+  // N buffered measures are equivalent to a single update with stacked
+  // measures.
+  Matrix Hs(N * m, n), Rs = Matrix::Zero(N * m, N * m), Y(m, N);
+  Vector ys(N * m), ys_pred(N * m);
+  x = F * x0;
+  for (int j = 0; j < N; ++j) {
+    Y.col(j) = H * x + Vector::Random(m);
+    Hs.middleRows(j * m, m) = H;
+    Rs.block(j * m, j * m, m, m) = R;
+    ys.segment(j * m, m) = Y.col(j);
+    ys_pred.segment(j * m, m) = H * x;
+  }
+  batch.modelMeasureSIN = Hs;
+  batch.noiseMeasureSIN = Rs;
+  batch.statePredictedSIN = x;
+  batch.observationPredictedSIN = ys_pred;
+  batch.measureSIN = ys;
+  batch.stateUpdateSOUT.recompute(20);
+  for (int i = 1; i < 4; ++i) {
+    filters[i]->measureBufferSIN = Y;
+    filters[i]->statePredictedSIN = x;
+    filters[i]->observationPredictedSIN = H * x;
+    filters[i]->stateUpdateSOUT.recompute(20);
+    BOOST_CHECK(batch.varianceUpdateSOUT.accessCopy().isApprox(
+        filters[i]->varianceUpdateSOUT.accessCopy()));
+    BOOST_CHECK(batch.stateUpdateSOUT.accessCopy().isApprox(
+        filters[i]->stateUpdateSOUT.accessCopy()));
+  }
+
+  // A measure without noise nor dependency on the state cannot be used,
+  // nor a negative noise variance.
+  const Matrix Hzero = Matrix::Zero(m, n), Rzero = Matrix::Zero(m, m),
+               Rnegative = -R;
+  Kalman *failing[3] = {&sequential, &squareRoot, &squareRoot};
+  const Matrix *Hfailing[3] = {&Hzero, &Hzero, &H};
+  const Matrix *Rfailing[3] = {&Rzero, &Rzero, &Rnegative};
+  for (int i = 0; i < 3; ++i) {
+    failing[i]->measureBufferSIN.unplug();
+    failing[i]->modelMeasureSIN = *Hfailing[i];
+    failing[i]->noiseMeasureSIN = *Rfailing[i];
+    try {
+      failing[i]->stateUpdateSOUT.recompute(21 + i);
+      BOOST_ERROR("No exception thrown.");
+    } catch (ExceptionTools &e) {
+      BOOST_CHECK_EQUAL(e.getCode(), ExceptionTools::KALMAN_NOT_INVERTIBLE);
+    }
+  }
+}
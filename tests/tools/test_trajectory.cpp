@@ -0,0 +1,287 @@
+/*
+ * Copyright 2020,
+ * CNRS/AIST
+ *
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#define BOOST_TEST_MODULE trajectory
+#include <boost/test/unit_test.hpp>
+
+#include <sot/core/exception-tools.hh>
+#include <sot/core/trajectory.hh>
+
+using namespace dynamicgraph;
+using namespace dynamicgraph::sot;
+
+static std::string makeTrajectory(const int nbJoints, const int nbPoints) {
+  std::ostringstream os;
+  char value[32];
+  os << "(3,(12.0,500.0),odom),(";
+  for (int j = 0; j < nbJoints; ++j)
+    os << (j ? "," : "") << "joint_" << j;
+  os << "),(";
+  for (int p = 0; p < nbPoints; ++p) {
+    os << (p ? "," : "") << "(";
+    for (int k = 0; k < 4; ++k) {
+      os << (k ? ",(" : "(");
+      // The accelerations are left empty.
+      for (int j = 0; k != 2 && j < nbJoints; ++j) {
+        std::sprintf(value, "%.6f", 0.001 * (p + 1) * (j - k));
+        os << (j ? "," : "") << value;
+      }
+      os << ")";
+    }
+    os << ")";
+  }
+  os << ")";
+  return os.str();
+}
+
+BOOST_AUTO_TEST_CASE(parse) {
+  const int nbJoints = 30, nbPoints = 20;
+  std::string text = makeTrajectory(nbJoints, nbPoints);
+
+  Trajectory traj;
+  traj.deserialize(text);
+  BOOST_CHECK_EQUAL(traj.header_.seq_, 3);
+  BOOST_CHECK_EQUAL(traj.header_.stamp_.secs_, 12);
+  BOOST_CHECK_EQUAL(traj.header_.stamp_.nsecs_, 500);
+  BOOST_CHECK_EQUAL(traj.header_.frame_id_, "odom");
+  BOOST_REQUIRE_EQUAL(traj.joint_names_.size(), nbJoints);
+  BOOST_CHECK_EQUAL(traj.joint_names_[7], "joint_7");
+  BOOST_REQUIRE_EQUAL(traj.nbPoints(), nbPoints);
+  BOOST_CHECK_EQUAL(traj.positions_.rows(), nbJoints);
+  BOOST_CHECK_EQUAL(traj.accelerations_.rows(), 0);
+  BOOST_CHECK_EQUAL(traj.accelerations_.cols(), nbPoints);
+  BOOST_CHECK_EQUAL(traj.point(4).velocities_(7), 0.001 * 5 * (7 - 1));
+
+  // Same result as the regular expression based parser.
+  Trajectory reference;
+  RulesJointTrajectory rules(reference);
+  std::string copy(text);
+  rules.parse_string(copy);
+  BOOST_CHECK(reference.joint_names_ == traj.joint_names_);
+  BOOST_REQUIRE_EQUAL(reference.nbPoints(), traj.nbPoints());
+  BOOST_CHECK(reference.positions_ == traj.positions_);
+  BOOST_CHECK(reference.velocities_ == traj.velocities_);
+  BOOST_CHECK(reference.efforts_ == traj.efforts_);
+
+  traj.deserialize(makeTrajectory(2, 1));
+  BOOST_CHECK_EQUAL(traj.joint_names_.size(), 2);
+  BOOST_CHECK_EQUAL(traj.nbPoints(), 1);
+  BOOST_CHECK_EQUAL(traj.positions_.rows(), 2);
+
+  // Python tuples are accepted as well.
+  traj.deserialize("((1, (2.0, 3.0), 'map'), ('a', 'b'),"
+                   " (((1.0, 2.0), (), (), ()),))");
+  BOOST_CHECK_EQUAL(traj.header_.frame_id_, "map");
+  BOOST_CHECK_EQUAL(traj.joint_names_[1], "b");
+  BOOST_REQUIRE_EQUAL(traj.nbPoints(), 1);
+  BOOST_CHECK_EQUAL(traj.positions_(1, 0), 2.0);
+  BOOST_CHECK_EQUAL(traj.times_from_start_(0), 0.);
+
+  // Time from start of the points.
+  traj.deserialize("(1,(2.0,3.0),map),(a),"
+                   "(((1.0),(),(),(),0.5),((2.0),(),(),(),1.5))");
+  BOOST_REQUIRE_EQUAL(traj.nbPoints(), 2);
+  BOOST_CHECK_EQUAL(traj.point(1).time_from_start_, 1.5);
+
+  BOOST_CHECK_THROW(traj.deserialize("(1,(2.0,3.0),map),(a,b),(((1.0,2.0"),
+                    ExceptionTools);
+  // All the points must have the same number of values.
+  BOOST_CHECK_THROW(traj.deserialize("(1,(2.0,3.0),map),(a,b),"
+                                     "(((1.0,2.0),(),(),()),((1.0),(),(),()))"),
+                    ExceptionTools);
+}
+
+BOOST_AUTO_TEST_CASE(display) {
+  // A trajectory read from a string with the positions only, as
+  // SignalCast<Trajectory> builds it, is displayed point by point.
+  Trajectory traj;
+  traj.deserialize("(1,(2.0,3.0),map),(a,b),"
+                   "(((1.0,2.0),(),(),()),((3.0,4.0),(),(),()))");
+  BOOST_REQUIRE_EQUAL(traj.nbPoints(), 2);
+  BOOST_CHECK_EQUAL(traj.velocities_.cols(), 2);
+  BOOST_CHECK_EQUAL(traj.accelerations_.cols(), 2);
+  BOOST_CHECK_EQUAL(traj.efforts_.cols(), 2);
+  BOOST_CHECK_EQUAL(traj.times_from_start_.size(), 2);
+
+  std::ostringstream os;
+  traj.display(os);
+  BOOST_CHECK(os.str().find("Joint(1)=b") != std::string::npos);
+  BOOST_CHECK(os.str().find("\n4\n") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(add_point) {
+  Trajectory traj;
+  JointTrajectoryPoint point;
+  point.positions_.assign(3, 1.);
+  point.efforts_.assign(2, 2.);
+  traj.addPoint(point);
+  point.positions_[1] = 3.;
+  traj.addPoint(point);
+  BOOST_REQUIRE_EQUAL(traj.nbPoints(), 2);
+  BOOST_CHECK_EQUAL(traj.point(1).positions_(1), 3.);
+  BOOST_CHECK_EQUAL(traj.point(0).positions_(1), 1.);
+  BOOST_CHECK_EQUAL(traj.point(1).efforts_.size(), 2);
+  BOOST_CHECK_EQUAL(traj.point(1).velocities_.size(), 0);
+
+  point.velocities_.assign(3, 0.);
+  BOOST_CHECK_THROW(traj.addPoint(point), ExceptionTools);
+  BOOST_CHECK_EQUAL(traj.nbPoints(), 2);
+
+  Trajectory other;
+  other.header_.seq_ = 5;
+  const double *data = traj.positions_.data();
+  traj.swap(other);
+  BOOST_CHECK_EQUAL(traj.nbPoints(), 0);
+  BOOST_CHECK_EQUAL(traj.header_.seq_, 5);
+  BOOST_CHECK_EQUAL(other.nbPoints(), 2);
+  BOOST_CHECK_EQUAL(other.positions_.data(), data);
+
+  other.clearPoints();
+  BOOST_CHECK_EQUAL(other.nbPoints(), 0);
+  other.addPoint(point);
+  BOOST_CHECK_EQUAL(other.velocities_.rows(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(binary) {
+  Trajectory traj;
+  traj.deserialize(makeTrajectory(7, 15));
+  traj.times_from_start_.setLinSpaced(15, 0., 1.4);
+  traj.saveBinaryFile("test_trajectory.bin");
+
+  Trajectory loaded;
+  loaded.loadBinaryFile("test_trajectory.bin");
+  BOOST_CHECK_EQUAL(loaded.header_.seq_, traj.header_.seq_);
+  BOOST_CHECK(loaded.header_.stamp_ == traj.header_.stamp_);
+  BOOST_CHECK_EQUAL(loaded.header_.frame_id_, traj.header_.frame_id_);
+  BOOST_CHECK(loaded.joint_names_ == traj.joint_names_);
+  BOOST_REQUIRE_EQUAL(loaded.nbPoints(), traj.nbPoints());
+  BOOST_CHECK(loaded.positions_ == traj.positions_);
+  BOOST_CHECK(loaded.velocities_ == traj.velocities_);
+  BOOST_CHECK_EQUAL(loaded.accelerations_.rows(), 0);
+  BOOST_CHECK_EQUAL(loaded.accelerations_.cols(), traj.nbPoints());
+  BOOST_CHECK(loaded.efforts_ == traj.efforts_);
+  BOOST_CHECK(loaded.times_from_start_ == traj.times_from_start_);
+
+  std::ostringstream os;
+  traj.serializeBinary(os);
+  std::string data = os.str();
+  BOOST_CHECK_THROW(loaded.deserializeBinary(data.data(), data.size() - 8),
+                    ExceptionTools);
+  data[0] = 'X';
+  BOOST_CHECK_THROW(loaded.deserializeBinary(data.data(), data.size()),
+                    ExceptionTools);
+  std::remove("test_trajectory.bin");
+
+  // Fields of the header, at their offsets in the binary format.
+  data = os.str();
+  const auto setField = [](std::string &d, const std::size_t offset,
+                           const uint32_t value) {
+    std::memcpy(&d[offset], &value, sizeof(value));
+  };
+  const std::size_t nbJointsOffset = 20, nbPointsOffset = 40,
+                    namesSizeOffset = 44, sizesOffset = 48;
+
+  // The number of positions must match the number of joint names.
+  std::string wrong(data);
+  setField(wrong, sizesOffset, 6);
+  BOOST_CHECK_THROW(loaded.deserializeBinary(wrong.data(), wrong.size()),
+                    ExceptionTools);
+
+  // Sizes whose product with the number of points overflows 64 bits, the
+  // expected size of the data being then only the header and the names.
+  uint32_t namesSize;
+  std::memcpy(&namesSize, &data[namesSizeOffset], sizeof(namesSize));
+  wrong = data.substr(0, 64 + namesSize);
+  setField(wrong, nbJointsOffset, 0);
+  setField(wrong, nbPointsOffset, 1u << 31);
+  const uint32_t sizes[4] = {0, (1u << 30) - 1, 0, 0};
+  for (std::size_t q = 0; q < 4; ++q)
+    setField(wrong, sizesOffset + 4 * q, sizes[q]);
+  BOOST_CHECK_THROW(loaded.deserializeBinary(wrong.data(), wrong.size()),
+                    ExceptionTools);
+}
+
+// p(t) = t^5 / 10 - t^3 + t + 2 and its derivatives.
+static double p(const double t) {
+  return 0.1 * std::pow(t, 5) - t * t * t + t + 2;
+}
+static double v(const double t) {
+  return 0.5 * std::pow(t, 4) - 3 * t * t + 1;
+}
+static double a(const double t) { return 2 * t * t * t - 6 * t; }
+
+BOOST_AUTO_TEST_CASE(interpolation) {
+  const double times[] = {0., 1., 3., 3.5};
+  Trajectory traj;
+  JointTrajectoryPoint point;
+  for (int i = 0; i < 4; ++i) {
+    const double t = times[i];
+    point.positions_.assign(1, p(t));
+    point.positions_.push_back(t);
+    point.velocities_.assign(1, v(t));
+    point.velocities_.push_back(1.);
+    point.accelerations_.assign(1, a(t));
+    point.accelerations_.push_back(0.);
+    point.time_from_start_ = t;
+    traj.addPoint(point);
+  }
+
+  BOOST_CHECK_EQUAL(traj.findSegment(0.5, 0), 0);
+  BOOST_CHECK_EQUAL(traj.findSegment(1., 0), 1);
+  BOOST_CHECK_EQUAL(traj.findSegment(3.2, 1), 2);
+  BOOST_CHECK_EQUAL(traj.findSegment(1.5, 2), 1);
+  BOOST_CHECK_EQUAL(traj.findSegment(10., 4), 2);
+  BOOST_CHECK_EQUAL(traj.findSegment(-1., 4), 0);
+  BOOST_CHECK_EQUAL(Trajectory().findSegment(1., 3), 0);
+
+  Vector q;
+  std::size_t segment = 0;
+  // The second joint moves at constant speed: all the interpolations are
+  // exact.
+  traj.interpolatePositions(2.2, Trajectory::INTERPOLATION_LINEAR, segment,
+                            q);
+  BOOST_CHECK_EQUAL(segment, 1);
+  BOOST_CHECK_CLOSE(q(0), p(1.) + 0.6 * (p(3.) - p(1.)), 1e-9);
+  BOOST_CHECK_CLOSE(q(1), 2.2, 1e-9);
+
+  // Quintic interpolation is exact for a polynomial of degree 5.
+  for (double t = 0.05; t < 3.5; t += 0.1) {
+    traj.interpolatePositions(t, Trajectory::INTERPOLATION_QUINTIC, segment,
+                              q);
+    BOOST_CHECK_CLOSE(q(0), p(t), 1e-9);
+    BOOST_CHECK_CLOSE(q(1), t, 1e-9);
+  }
+
+  // Cubic Hermite interpolation matches the positions and velocities at
+  // the points.
+  const double eps = 1e-6;
+  Vector q1;
+  traj.interpolatePositions(1. + eps, Trajectory::INTERPOLATION_CUBIC,
+                            segment, q1);
+  traj.interpolatePositions(1., Trajectory::INTERPOLATION_CUBIC, segment, q);
+  BOOST_CHECK_CLOSE(q(0), p(1.), 1e-9);
+  BOOST_CHECK_CLOSE((q1(0) - q(0)) / eps, v(1.), 1e-3);
+
+  // Without accelerations, quintic interpolation falls back to cubic.
+  Vector qc;
+  traj.interpolatePositions(2.2, Trajectory::INTERPOLATION_CUBIC, segment,
+                            qc);
+  traj.accelerations_.resize(0, 4);
+  traj.interpolatePositions(2.2, Trajectory::INTERPOLATION_QUINTIC, segment,
+                            q);
+  BOOST_CHECK(q == qc);
+
+  // The positions are constant outside of the trajectory.
+  traj.interpolatePositions(-1., Trajectory::INTERPOLATION_CUBIC, segment, q);
+  BOOST_CHECK_EQUAL(q(0), p(0.));
+  traj.interpolatePositions(5., Trajectory::INTERPOLATION_CUBIC, segment, q);
+  BOOST_CHECK_EQUAL(q(0), p(3.5));
+}
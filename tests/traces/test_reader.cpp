@@ -0,0 +1,194 @@
+/*
+ * Copyright 2020,
+ * CNRS/AIST
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <sot/core/debug.hh>
+
+#include <sot/core/reader.hh>
+
+using namespace dynamicgraph;
+using namespace dynamicgraph::sot;
+
+#define BOOST_TEST_MODULE test - reader
+
+#include <boost/test/unit_test.hpp>
+
+static void writeFile(const char *filename, const char *content) {
+  std::ofstream file(filename);
+  file << content;
+}
+
+BOOST_AUTO_TEST_CASE(test_reader) {
+  // The last line does not end with a new line.
+  writeFile("test_reader_1.dat", "# time a b c\n"
+                                 "0\t1.5\t2.5\t3.5\n"
+                                 "\n"
+                                 "1 4 5 6\n"
+                                 "2 7 8 9");
+  writeFile("test_reader_2.dat", "3 10 11 12\n");
+
+  sotReader reader("reader");
+  int t = 0;
+  // Files loaded after the end of the data are played.
+  BOOST_CHECK_EQUAL(reader.vectorSOUT(++t).size(), 0);
+  reader.load("test_reader_1.dat");
+
+  const Vector &v1 = reader.vectorSOUT(++t);
+  BOOST_REQUIRE_EQUAL(v1.size(), 4);
+  BOOST_CHECK_EQUAL(v1(1), 1.5);
+  BOOST_CHECK_EQUAL(reader.vectorSOUT(++t)(3), 6.);
+  BOOST_CHECK_EQUAL(reader.vectorSOUT(++t)(2), 8.);
+  // At the end of the data, the last line is kept.
+  BOOST_CHECK_EQUAL(reader.vectorSOUT(++t)(0), 2.);
+
+  reader.rewind();
+  BOOST_CHECK_EQUAL(reader.vectorSOUT(++t)(0), 0.);
+
+  // Only the selected columns are read.
+  reader.selectionSIN = Flags("0101");
+  const Vector &v2 = reader.vectorSOUT(++t);
+  BOOST_REQUIRE_EQUAL(v2.size(), 2);
+  BOOST_CHECK_EQUAL(v2(0), 4.);
+  BOOST_CHECK_EQUAL(v2(1), 6.);
+
+  // The lines of the files are played one after the other.
+  reader.load("test_reader_2.dat");
+  BOOST_CHECK_EQUAL(reader.vectorSOUT(++t)(0), 7.);
+  BOOST_CHECK_EQUAL(reader.vectorSOUT(++t)(0), 10.);
+
+  reader.clear();
+  reader.rewind();
+  BOOST_CHECK_EQUAL(reader.vectorSOUT(++t)(0), 10.);
+
+  // The values of a line end at the first token which is not a number.
+  writeFile("test_reader_5.dat", "1 2 # comment\n");
+  reader.clear();
+  reader.selectionSIN = true;
+  reader.load("test_reader_5.dat");
+  const Vector &v3 = reader.vectorSOUT(++t);
+  BOOST_REQUIRE_EQUAL(v3.size(), 2);
+  BOOST_CHECK_EQUAL(v3(1), 2.);
+
+  BOOST_CHECK_THROW(reader.load("test_reader_missing.dat"), ExceptionTraces);
+}
+
+/// Give access to the number of lines parsed ahead.
+struct StreamingReader : public sotReader {
+  StreamingReader(const std::string &name) : sotReader(name) {}
+
+  /// Wait until \c n lines are ready.
+  void waitFor(const std::size_t n) {
+    for (int i = 0; i < 1000 && ringHead - ringTail < n; ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    BOOST_REQUIRE(ringHead - ringTail >= n);
+  }
+};
+
+BOOST_AUTO_TEST_CASE(test_reader_streaming) {
+  writeFile("test_reader_3.dat", "0 1 2\n"
+                                 "1 3 4\n"
+                                 "2 5 x\n"
+                                 "3 7 8\n");
+
+  StreamingReader reader("streaming_reader");
+  reader.setStreaming(2);
+  reader.load("test_reader_3.dat");
+  BOOST_CHECK_THROW(reader.setStreaming(-1), ExceptionTraces);
+
+  int t = 0;
+  reader.waitFor(2);
+  BOOST_CHECK_EQUAL(reader.vectorSOUT(++t)(1), 1.);
+  reader.selectionSIN = Flags("011");
+  const Vector &v = reader.vectorSOUT(++t);
+  BOOST_REQUIRE_EQUAL(v.size(), 2);
+  BOOST_CHECK_EQUAL(v(0), 3.);
+  BOOST_CHECK_EQUAL(v(1), 4.);
+
+  // The values of a line end at the first token which is not a number.
+  reader.waitFor(2);
+  const Vector &w = reader.vectorSOUT(++t);
+  BOOST_REQUIRE_EQUAL(w.size(), 1);
+  BOOST_CHECK_EQUAL(w(0), 5.);
+  BOOST_CHECK_EQUAL(reader.vectorSOUT(++t)(1), 8.);
+  // At the end of the data, the last line is kept.
+  BOOST_CHECK_EQUAL(reader.vectorSOUT(++t)(1), 8.);
+
+  reader.rewind();
+  reader.waitFor(1);
+  BOOST_CHECK_EQUAL(reader.vectorSOUT(++t)(1), 2.);
+
+  // Without streaming, the lines are parsed when they are played.
+  reader.setStreaming(0);
+  reader.rewind();
+  BOOST_CHECK_EQUAL(reader.vectorSOUT(++t)(0), 1.);
+}
+
+BOOST_AUTO_TEST_CASE(test_reader_streaming_same_values) {
+  writeFile("test_reader_6.dat", "# time a b\n"
+                                 "0 1 2 # comment\n"
+                                 "1 x 3\n"
+                                 "not a line\n"
+                                 "2 4e1 -.5 6\n"
+                                 "3 +7 8.\n");
+
+  // Both modes read the same values from the same file.
+  sotReader direct("direct_reader");
+  direct.load("test_reader_6.dat");
+  StreamingReader streaming("same_streaming_reader");
+  streaming.setStreaming(4);
+  streaming.load("test_reader_6.dat");
+  streaming.waitFor(4);
+
+  const Vector expected[4] = {(Vector(3) << 0., 1., 2.).finished(),
+                              (Vector(1) << 1.).finished(),
+                              (Vector(4) << 2., 40., -0.5, 6.).finished(),
+                              (Vector(3) << 3., 7., 8.).finished()};
+  for (int t = 1; t <= 4; ++t) {
+    const Vector &v = direct.vectorSOUT(t);
+    const Vector &w = streaming.vectorSOUT(t);
+    BOOST_CHECK_EQUAL(v, expected[t - 1]);
+    BOOST_CHECK_EQUAL(w, expected[t - 1]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_reader_reset_while_playing) {
+  std::ostringstream content;
+  for (int i = 0; i < 100; ++i)
+    content << i << " " << i + 1 << "\n";
+  writeFile("test_reader_4.dat", content.str().c_str());
+
+  sotReader reader("reset_reader");
+  reader.load("test_reader_4.dat");
+
+  // The graph keeps playing the lines while the data is reset.
+  std::atomic<bool> stop(false);
+  std::atomic<int> wrong(0);
+  std::thread graph([&]() {
+    for (int t = 1; !stop; ++t) {
+      const Vector &v = reader.vectorSOUT(t);
+      if (v.size() != 0 && (v.size() != 2 || v(1) != v(0) + 1))
+        ++wrong;
+    }
+  });
+  for (int i = 0; i < 50; ++i) {
+    reader.setStreaming(i % 3 == 0 ? 0 : 4);
+    reader.rewind();
+    if (i % 10 == 9) {
+      reader.clear();
+      reader.load("test_reader_4.dat");
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  stop = true;
+  graph.join();
+  BOOST_CHECK_EQUAL(wrong, 0);
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright 2020,
+ * CNRS/AIST
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <thread>
+
+#include <dynamic-graph/signal.h>
+#include <sot/core/binary-trace.hh>
+#include <sot/core/reader.hh>
+#include <sot/core/recorder.hh>
+
+using namespace dynamicgraph;
+using namespace dynamicgraph::sot;
+
+#define BOOST_TEST_MODULE test - recorder
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(test_recorder) {
+  Signal<double, int> d("d");
+  Signal<Vector, int> v("v");
+  Signal<Matrix, int> m("m");
+
+  Recorder recorder("recorder");
+  recorder.addDouble("d");
+  recorder.addVector("v", 2);
+  recorder.addMatrix("m", 2, 2);
+  BOOST_CHECK_THROW(recorder.addVector("v", 3), ExceptionTraces);
+  BOOST_CHECK_THROW(recorder.addVector("w", 0), ExceptionTraces);
+  recorder.getSignal("d").plug(&d);
+  recorder.getSignal("v").plug(&v);
+  recorder.getSignal("m").plug(&m);
+
+  // Nothing is recorded before the file is opened.
+  recorder.triggerSOUT(0);
+
+  recorder.open("test_recorder.dat", 2);
+  BOOST_CHECK_THROW(recorder.addDouble("e"), ExceptionTraces);
+  Vector vv(2);
+  Matrix mm(2, 2);
+  for (int t = 1; t <= 10; ++t) {
+    d = 0.5 * t;
+    vv << t, -t;
+    v = vv;
+    mm << 1, 2, 3, 4;
+    m = mm * t;
+    recorder.triggerSOUT(t);
+    // Leave time to the thread to write the ring, which holds 2 records.
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  recorder.close();
+  const int dropped = recorder.getDropped();
+  BOOST_CHECK(dropped <= 8);
+
+  // The values of a record are read in the order of the header.
+  sotReader reader("reader");
+  reader.load("test_recorder.dat");
+  int t = 0;
+  const Vector &first = reader.vectorSOUT(++t);
+  BOOST_REQUIRE_EQUAL(first.size(), 8);
+  BOOST_CHECK_EQUAL(first(0), 1.);
+  BOOST_CHECK_EQUAL(first(1), 0.5);
+  BOOST_CHECK_EQUAL(first(2), 1.);
+  BOOST_CHECK_EQUAL(first(3), -1.);
+  // Matrices are in row major order.
+  BOOST_CHECK_EQUAL(first(4), 1.);
+  BOOST_CHECK_EQUAL(first(5), 2.);
+  BOOST_CHECK_EQUAL(first(6), 3.);
+  BOOST_CHECK_EQUAL(first(7), 4.);
+
+  // The records are the ones which were not dropped.
+  double time = 1.;
+  for (int i = 1; i < 10 - dropped; ++i) {
+    const Vector &record = reader.vectorSOUT(++t);
+    BOOST_CHECK(record(0) > time);
+    time = record(0);
+    BOOST_CHECK_EQUAL(record(1), 0.5 * time);
+    BOOST_CHECK_EQUAL(record(7), 4. * time);
+  }
+  // At the end of the data, the last record is kept.
+  BOOST_CHECK_EQUAL(reader.vectorSOUT(++t)(0), time);
+
+  // The selection applies to the records as to the lines of a text trace.
+  reader.rewind();
+  reader.selectionSIN = Flags("0001");
+  const Vector &selected = reader.vectorSOUT(++t);
+  BOOST_REQUIRE_EQUAL(selected.size(), 1);
+  BOOST_CHECK_EQUAL(selected(0), -1.);
+
+  reader.setStreaming(4);
+  reader.rewind();
+  reader.selectionSIN = Flags("01");
+  for (int i = 0; i < 1000 && reader.vectorSOUT(++t)(0) != 0.5; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  BOOST_CHECK_EQUAL(reader.vectorSOUT(t)(0), 0.5);
+}
+
+BOOST_AUTO_TEST_CASE(test_recorder_close_while_recording) {
+  Signal<double, int> d("d");
+  Recorder recorder("recorder");
+  recorder.addDouble("d");
+  recorder.getSignal("d").plug(&d);
+
+  // The graph keeps evaluating the trigger while the file is reopened.
+  std::atomic<bool> stop(false);
+  std::thread graph([&]() {
+    for (int t = 1; !stop; ++t) {
+      d = 0.5 * t;
+      recorder.triggerSOUT(t);
+    }
+  });
+  for (int i = 0; i < 20; ++i) {
+    recorder.open("test_recorder_reopen.dat", 8);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  recorder.close();
+  stop = true;
+  graph.join();
+
+  // The file holds whole records only.
+  sotReader reader("reader");
+  reader.load("test_recorder_reopen.dat");
+  for (int t = 1; t < 100; ++t) {
+    const Vector &record = reader.vectorSOUT(t);
+    BOOST_REQUIRE_EQUAL(record.size(), 2);
+    BOOST_CHECK_EQUAL(record(1), 0.5 * record(0));
+  }
+  std::remove("test_recorder_reopen.dat");
+}
+
+BOOST_AUTO_TEST_CASE(test_binary_trace_header) {
+  BinaryTraceHeader header;
+  header.entries.resize(2);
+  header.entries[0].name = "a";
+  header.entries[0].rows = 3;
+  header.entries[0].cols = 1;
+  header.entries[1].name = "matrix";
+  header.entries[1].rows = 2;
+  header.entries[1].cols = 3;
+  BOOST_CHECK_EQUAL(header.recordSize(), 10);
+
+  std::ostringstream os;
+  header.write(os);
+  const std::string data = os.str();
+  BOOST_CHECK_EQUAL(data.size() % 8, 0);
+  BOOST_CHECK(BinaryTraceHeader::isBinaryTrace(data.data(), data.size()));
+  BOOST_CHECK(!BinaryTraceHeader::isBinaryTrace("0 1 2\n", 6));
+
+  BinaryTraceHeader read;
+  BOOST_CHECK_EQUAL(read.read(data.data(), data.size()), data.size());
+  BOOST_REQUIRE_EQUAL(read.entries.size(), 2);
+  BOOST_CHECK_EQUAL(read.entries[1].name, "matrix");
+  BOOST_CHECK_EQUAL(read.entries[1].cols, 3);
+  BOOST_CHECK_THROW(read.read(data.data(), data.size() - 8), ExceptionTraces);
+}